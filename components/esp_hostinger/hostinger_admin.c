@@ -1,55 +1,17 @@
 #include <stdio.h>
 #include <string.h>
 #include "esp_log.h"
-#include "esp_err.h"
-#include "esp_http_client.h"
-#include "esp_crt_bundle.h"
 #include "hostinger_ingest.h"
+#include "hostinger_http.h"
+#include "hostinger_latency.h"
 #include "Privado.h"
 
 static const char* TAGA = "HOST_ADMIN";
 
-#define HTTP_BODY_DEBUG 0   // 1 = imprime hasta 256 bytes del body; 0 = apagado
-
-#if HTTP_BODY_DEBUG
-static esp_err_t http_evt(esp_http_client_event_t *evt) {
-    if (evt->event_id == HTTP_EVENT_ON_DATA && evt->data_len > 0) {
-        int n = evt->data_len > 256 ? 256 : evt->data_len;
-        char buf[260]; memcpy(buf, evt->data, n); buf[n] = 0;
-        ESP_LOGW("HTTP_BODY", "%s", buf);
-    }
-    return ESP_OK;
-}
-#endif
-
+// Usa el pool compartido: si ingest ya tiene socket abierto al mismo host,
+// la operación admin lo reutiliza en vez de hacer su propio handshake.
 static int post_json(const char* url, const char* json_body) {
-    esp_http_client_config_t cfg = {
-        .url = url,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-        .timeout_ms = 15000,
-        .disable_auto_redirect = true,
-    #if HTTP_BODY_DEBUG
-        .event_handler = http_evt,
-    #endif
-
-    };
-    esp_http_client_handle_t cli = esp_http_client_init(&cfg);
-    if (!cli) return -2;
-    esp_http_client_set_method(cli, HTTP_METHOD_POST);
-    esp_http_client_set_header(cli, "Content-Type", "application/json");
-    esp_http_client_set_header(cli, "X-API-Key", HOSTINGER_API_KEY);
-    esp_http_client_set_header(cli, "Connection", "close");
-    esp_http_client_set_post_field(cli, json_body, strlen(json_body));
-
-    esp_err_t err = esp_http_client_perform(cli);
-    int status = -1;
-    if (err == ESP_OK) status = esp_http_client_get_status_code(cli);
-    else ESP_LOGE(TAGA, "HTTP error: %s", esp_err_to_name(err));
-
-    esp_http_client_cleanup(cli);
-    if (err != ESP_OK) return (int)err;
-    if (status < 200 || status >= 300) return -100 - status;
-    return 0;
+    return hostinger_http_post_buf(url, "application/json", json_body, strlen(json_body), NULL, 0);
 }
 
 int hostinger_delete_all_for_device(const char* device_id) {
@@ -70,3 +32,20 @@ int hostinger_trim_oldest_batch(const char* device_id, int batch_size) {
     ESP_LOGI(TAGA, "TRIM_OLDEST(%s,%d) => %d", device_id ? device_id : DEVICE_ID, batch_size, rc);
     return rc;
 }
+
+int hostinger_post_latency_telemetry(const char* device_id) {
+    return hostinger_post_telemetry(device_id, NULL);
+}
+
+int hostinger_post_telemetry(const char* device_id, const char* extra) {
+    const char* dev = device_id ? device_id : DEVICE_ID;
+    char lat[640];
+    if (hostinger_lat_format_json(lat, sizeof(lat)) < 0) return -1;
+    char body[1152];
+    int n = snprintf(body, sizeof(body), "{\"op\":\"telemetry\",\"device_id\":\"%s\",\"lat\":%s%s%s}",
+                     dev, lat, extra ? "," : "", extra ? extra : "");
+    if (n < 0 || n >= (int)sizeof(body)) return -1;
+    int rc = post_json(HOSTINGER_URL_ADMIN, body);
+    ESP_LOGI(TAGA, "TELEMETRY(%s) => %d", dev, rc);
+    return rc;
+}
@@ -0,0 +1,183 @@
+#include <stdbool.h>
+#include <string.h>
+#include "esp_rom_crc.h"
+#include "hostinger_gzip.h"
+
+#define GZ_MIN_MATCH   3
+#define GZ_MAX_MATCH   258
+#define GZ_HASH_SIZE   (1 << HOSTINGER_GZIP_HASH_BITS)
+#define GZ_NO_POS      (-1)
+
+// Tablas de deflate (RFC 1951 3.2.5)
+static const uint16_t s_len_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t s_len_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t s_dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t s_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// ---------- Salida de bits (LSB primero) ----------
+static void gz_flush_out(hostinger_gzip_t *z) {
+    if (z->out_len == 0) return;
+    if (z->err == ESP_OK) z->err = z->sink(z->sink_ctx, z->out, z->out_len);
+    z->out_total += (uint32_t)z->out_len;
+    z->out_len = 0;
+}
+
+static void gz_put_byte(hostinger_gzip_t *z, uint8_t b) {
+    z->out[z->out_len++] = b;
+    if (z->out_len == sizeof(z->out)) gz_flush_out(z);
+}
+
+static void gz_put_bits(hostinger_gzip_t *z, uint32_t bits, int n) {
+    z->bitbuf |= bits << z->bitcnt;
+    z->bitcnt += n;
+    while (z->bitcnt >= 8) {
+        gz_put_byte(z, (uint8_t)z->bitbuf);
+        z->bitbuf >>= 8;
+        z->bitcnt -= 8;
+    }
+}
+
+// Los códigos Huffman se emiten desde el bit más significativo
+static void gz_put_code(hostinger_gzip_t *z, uint32_t code, int n) {
+    uint32_t rev = 0;
+    for (int i = 0; i < n; ++i) {
+        rev = (rev << 1) | (code & 1);
+        code >>= 1;
+    }
+    gz_put_bits(z, rev, n);
+}
+
+// Símbolo literal/longitud con el código fijo
+static void gz_put_litlen(hostinger_gzip_t *z, int sym) {
+    if (sym < 144)      gz_put_code(z, 0x30 + sym, 8);
+    else if (sym < 256) gz_put_code(z, 0x190 + (sym - 144), 9);
+    else if (sym < 280) gz_put_code(z, sym - 256, 7);
+    else                gz_put_code(z, 0xC0 + (sym - 280), 8);
+}
+
+static void gz_put_match(hostinger_gzip_t *z, int len, int dist) {
+    int li = 28;
+    while (s_len_base[li] > len) li--;
+    gz_put_litlen(z, 257 + li);
+    if (s_len_extra[li]) gz_put_bits(z, (uint32_t)(len - s_len_base[li]), s_len_extra[li]);
+
+    int di = 29;
+    while (s_dist_base[di] > dist) di--;
+    gz_put_code(z, (uint32_t)di, 5);
+    if (s_dist_extra[di]) gz_put_bits(z, (uint32_t)(dist - s_dist_base[di]), s_dist_extra[di]);
+}
+
+// ---------- LZ77 ----------
+static inline uint32_t gz_hash(const uint8_t *p) {
+    uint32_t h = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (h * 2654435761u) >> (32 - HOSTINGER_GZIP_HASH_BITS);
+}
+
+static void gz_insert(hostinger_gzip_t *z, size_t at) {
+    if (at + GZ_MIN_MATCH <= z->end) z->head[gz_hash(&z->win[at])] = (int16_t)at;
+}
+
+// Codifica mientras quede anticipo suficiente (o todo, si final)
+static void gz_deflate(hostinger_gzip_t *z, bool final) {
+    size_t need = final ? 1 : GZ_MAX_MATCH;
+    while (z->pos < z->end && z->end - z->pos >= need) {
+        size_t avail = z->end - z->pos;
+        int best = 0;
+        size_t cand_pos = 0;
+
+        if (avail >= GZ_MIN_MATCH) {
+            uint32_t h = gz_hash(&z->win[z->pos]);
+            int16_t cand = z->head[h];
+            z->head[h] = (int16_t)z->pos;
+            if (cand != GZ_NO_POS && (size_t)cand < z->pos &&
+                z->pos - (size_t)cand <= HOSTINGER_GZIP_WINDOW) {
+                size_t max = avail < GZ_MAX_MATCH ? avail : GZ_MAX_MATCH;
+                size_t n = 0;
+                while (n < max && z->win[cand + n] == z->win[z->pos + n]) n++;
+                if (n >= GZ_MIN_MATCH) {
+                    best = (int)n;
+                    cand_pos = (size_t)cand;
+                }
+            }
+        }
+
+        if (best) {
+            gz_put_match(z, best, (int)(z->pos - cand_pos));
+            for (int i = 1; i < best; ++i) gz_insert(z, z->pos + i);
+            z->pos += best;
+        } else {
+            gz_put_litlen(z, z->win[z->pos]);
+            z->pos++;
+        }
+    }
+}
+
+// Desplaza la ventana una mitad cuando se llena
+static void gz_slide(hostinger_gzip_t *z) {
+    memmove(z->win, z->win + HOSTINGER_GZIP_WINDOW, z->end - HOSTINGER_GZIP_WINDOW);
+    z->pos -= HOSTINGER_GZIP_WINDOW;
+    z->end -= HOSTINGER_GZIP_WINDOW;
+    for (int i = 0; i < GZ_HASH_SIZE; ++i) {
+        z->head[i] = (z->head[i] >= HOSTINGER_GZIP_WINDOW)
+                   ? (int16_t)(z->head[i] - HOSTINGER_GZIP_WINDOW) : GZ_NO_POS;
+    }
+}
+
+// ---------- API ----------
+void hostinger_gzip_init(hostinger_gzip_t *z, hostinger_gzip_sink_t sink, void *ctx) {
+    memset(z, 0, sizeof(*z));
+    z->sink = sink;
+    z->sink_ctx = ctx;
+    for (int i = 0; i < GZ_HASH_SIZE; ++i) z->head[i] = GZ_NO_POS;
+
+    // Encabezado gzip: deflate, sin nombre ni mtime, SO desconocido
+    static const uint8_t hdr[10] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+    for (size_t i = 0; i < sizeof(hdr); ++i) gz_put_byte(z, hdr[i]);
+
+    // Un único bloque final con códigos fijos (BFINAL=1, BTYPE=01)
+    gz_put_bits(z, 1, 1);
+    gz_put_bits(z, 1, 2);
+}
+
+esp_err_t hostinger_gzip_write(hostinger_gzip_t *z, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    z->crc = esp_rom_crc32_le(z->crc, p, (uint32_t)len);
+    z->in_total += (uint32_t)len;
+
+    while (len > 0 && z->err == ESP_OK) {
+        if (z->end == sizeof(z->win)) {
+            gz_deflate(z, false);
+            gz_slide(z);
+        }
+        size_t room = sizeof(z->win) - z->end;
+        size_t n = len < room ? len : room;
+        memcpy(z->win + z->end, p, n);
+        z->end += n;
+        p += n;
+        len -= n;
+    }
+    return z->err;
+}
+
+esp_err_t hostinger_gzip_finish(hostinger_gzip_t *z) {
+    gz_deflate(z, true);
+    gz_put_litlen(z, 256);                 // fin de bloque
+    if (z->bitcnt > 0) gz_put_bits(z, 0, 8 - z->bitcnt);
+
+    for (int i = 0; i < 4; ++i) gz_put_byte(z, (uint8_t)(z->crc >> (8 * i)));
+    for (int i = 0; i < 4; ++i) gz_put_byte(z, (uint8_t)(z->in_total >> (8 * i)));
+    gz_flush_out(z);
+    return z->err;
+}
@@ -0,0 +1,313 @@
+#include <string.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_http_client.h"
+#include "hostinger_http.h"
+#include "hostinger_tls.h"
+#include "hostinger_latency.h"
+#include "Privado.h"
+
+static const char* TAG = "HOST_HTTP";
+
+#define HTTP_BODY_DEBUG 0   // 1 = imprime hasta 256 bytes del body; 0 = apagado
+
+#define HTTP_TIMEOUT_MS          15000
+// Keepalive TCP: mantiene viva la entrada NAT del operador y detecta sockets muertos
+#define HTTP_TCP_KA_IDLE_S       60
+#define HTTP_TCP_KA_INTVL_S      15
+#define HTTP_TCP_KA_COUNT        3
+// Si la conexión lleva más de esto sin usarse, no se confía en ella y se recicla
+#define HTTP_MAX_IDLE_MS         (15 * 60 * 1000)
+// Espera máxima por un cliente libre del pool
+#define HTTP_POOL_WAIT_MS        (2 * HTTP_TIMEOUT_MS)
+// Los fragmentos chicos se juntan antes de escribir: cada write es un registro TLS
+#define HTTP_TX_COALESCE         512
+#define HTTP_HOST_MAX            64
+
+typedef struct {
+    esp_http_client_handle_t cli;
+    char host[HTTP_HOST_MAX];       // "host[:puerto]" al que apunta el handle
+    bool busy;
+    bool connected_now;             // se levantó socket nuevo en este request
+    int64_t last_use_us;            // 0 = sin conexión abierta
+    char *resp;                     // captura de la respuesta del request en curso
+    size_t resp_size;
+    size_t resp_len;
+    uint8_t tx[HTTP_TX_COALESCE];
+    size_t tx_len;
+    hostinger_lat_probe_t lat;      // fases del request en curso
+} http_slot_t;
+
+static http_slot_t s_pool[HOSTINGER_HTTP_POOL_SIZE];
+static SemaphoreHandle_t s_pool_mtx = NULL;
+static SemaphoreHandle_t s_pool_free = NULL;
+static hostinger_http_stats_t s_stats;
+
+static esp_err_t http_evt(esp_http_client_event_t *evt) {
+    http_slot_t *slot = (http_slot_t *)evt->user_data;
+    hostinger_lat_event(&slot->lat, evt);
+    switch (evt->event_id) {
+    case HTTP_EVENT_ON_CONNECTED:
+        slot->connected_now = true;
+        s_stats.connects++;
+        break;
+    case HTTP_EVENT_ON_DATA:
+        if (evt->data_len > 0) {
+            if (slot->resp && slot->resp_size > 1) {
+                size_t room = slot->resp_size - slot->resp_len - 1;
+                size_t n = (size_t)evt->data_len < room ? (size_t)evt->data_len : room;
+                memcpy(slot->resp + slot->resp_len, evt->data, n);
+                slot->resp_len += n;
+                slot->resp[slot->resp_len] = 0;
+            }
+#if HTTP_BODY_DEBUG
+            int m = evt->data_len > 256 ? 256 : evt->data_len;
+            char buf[260]; memcpy(buf, evt->data, m); buf[m] = 0;
+            ESP_LOGW("HTTP_BODY", "%s", buf);
+#endif
+        }
+        break;
+    default:
+        break;
+    }
+    return ESP_OK;
+}
+
+// "https://host:443/ruta" -> "host:443"
+static void url_host(const char *url, char *out, size_t size) {
+    const char *p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    size_t n = strcspn(p, "/?#");
+    if (n >= size) n = size - 1;
+    memcpy(out, p, n);
+    out[n] = 0;
+}
+
+static bool pool_init(void) {
+    if (s_pool_mtx) return true;
+    s_pool_mtx = xSemaphoreCreateMutex();
+    s_pool_free = xSemaphoreCreateCounting(HOSTINGER_HTTP_POOL_SIZE, HOSTINGER_HTTP_POOL_SIZE);
+    return s_pool_mtx && s_pool_free;
+}
+
+// Cierra solo el socket: el handle (y su ticket TLS) se conserva para que la
+// siguiente conexión reanude la sesión en vez de renegociar completa.
+static void slot_conn_close(http_slot_t *slot) {
+    if (!slot->cli) return;
+    esp_http_client_close(slot->cli);
+    slot->last_use_us = 0;
+}
+
+// Toma un cliente libre: preferentemente uno ya conectado al host, si no
+// uno vacío y, en último caso, el libre usado hace más tiempo.
+static http_slot_t *pool_acquire(const char *url) {
+    if (!pool_init()) return NULL;
+    if (xSemaphoreTake(s_pool_free, 0) != pdTRUE) {
+        s_stats.pool_waits++;
+        if (xSemaphoreTake(s_pool_free, pdMS_TO_TICKS(HTTP_POOL_WAIT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "Pool HTTP ocupado");
+            return NULL;
+        }
+    }
+
+    char host[HTTP_HOST_MAX];
+    url_host(url, host, sizeof(host));
+
+    xSemaphoreTake(s_pool_mtx, portMAX_DELAY);
+    http_slot_t *same = NULL, *empty = NULL, *lru = NULL;
+    for (int i = 0; i < HOSTINGER_HTTP_POOL_SIZE; ++i) {
+        http_slot_t *sl = &s_pool[i];
+        if (sl->busy) continue;
+        if (!sl->cli) {
+            if (!empty) empty = sl;
+        } else if (strcmp(sl->host, host) == 0) {
+            if (!same) same = sl;
+        } else if (!lru || sl->last_use_us < lru->last_use_us) {
+            lru = sl;
+        }
+    }
+    http_slot_t *pick = same ? same : (empty ? empty : lru);
+    pick->busy = true;
+    xSemaphoreGive(s_pool_mtx);
+
+    if (pick->cli && strcmp(pick->host, host) != 0) {
+        slot_conn_close(pick);   // otro host: el socket no sirve
+    }
+    strlcpy(pick->host, host, sizeof(pick->host));
+    return pick;
+}
+
+static void pool_release(http_slot_t *slot) {
+    slot->resp = NULL;
+    xSemaphoreTake(s_pool_mtx, portMAX_DELAY);
+    slot->busy = false;
+    xSemaphoreGive(s_pool_mtx);
+    xSemaphoreGive(s_pool_free);
+}
+
+static esp_http_client_handle_t slot_client(http_slot_t *slot, const char *url) {
+    if (slot->cli && slot->last_use_us > 0) {
+        int64_t idle_ms = (esp_timer_get_time() - slot->last_use_us) / 1000;
+        if (idle_ms > HTTP_MAX_IDLE_MS) {
+            ESP_LOGI(TAG, "Conexión inactiva %lld s; se recicla", (long long)(idle_ms / 1000));
+            slot_conn_close(slot);
+        }
+    }
+    if (slot->cli) {
+        esp_http_client_set_url(slot->cli, url);   // mismo host: conserva el socket
+        return slot->cli;
+    }
+
+    esp_http_client_config_t cfg = {
+        .url = url,
+        .timeout_ms = HTTP_TIMEOUT_MS,
+        .disable_auto_redirect = true,
+        .keep_alive_enable = true,
+        .keep_alive_idle = HTTP_TCP_KA_IDLE_S,
+        .keep_alive_interval = HTTP_TCP_KA_INTVL_S,
+        .keep_alive_count = HTTP_TCP_KA_COUNT,
+        .event_handler = http_evt,
+        .user_data = slot,
+    };
+    hostinger_tls_apply(&cfg);
+    slot->cli = esp_http_client_init(&cfg);
+    if (!slot->cli) return NULL;
+
+    esp_http_client_set_method(slot->cli, HTTP_METHOD_POST);
+    esp_http_client_set_header(slot->cli, "X-API-Key", HOSTINGER_API_KEY);
+    return slot->cli;
+}
+
+// ---------- Escritura del body ----------
+// Los fragmentos chicos se acumulan en slot->tx y los que no caben se
+// escriben directo desde el buffer del llamador.
+static esp_err_t slot_write(http_slot_t *slot, const uint8_t *data, size_t len) {
+    int w = esp_http_client_write(slot->cli, (const char *)data, (int)len);
+    return (w == (int)len) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t slot_flush(http_slot_t *slot) {
+    esp_err_t err = slot->tx_len ? slot_write(slot, slot->tx, slot->tx_len) : ESP_OK;
+    slot->tx_len = 0;
+    return err;
+}
+
+static esp_err_t slot_sink(void *ctx, const uint8_t *data, size_t len) {
+    http_slot_t *slot = (http_slot_t *)ctx;
+    if (slot->tx_len + len <= sizeof(slot->tx)) {
+        memcpy(slot->tx + slot->tx_len, data, len);
+        slot->tx_len += len;
+        return ESP_OK;
+    }
+    esp_err_t err = slot_flush(slot);
+    if (err != ESP_OK) return err;
+    if (len < sizeof(slot->tx)) return slot_sink(ctx, data, len);
+    return slot_write(slot, data, len);
+}
+
+// ---------- API ----------
+int hostinger_http_post(const hostinger_http_req_t *req) {
+    if (!req || !req->url || !req->write_body) return -1;
+    http_slot_t *slot = pool_acquire(req->url);
+    if (!slot) return -2;
+    s_stats.requests++;
+
+    // Máximo 2 pasadas: si la conexión reutilizada resultó muerta (NAT/servidor
+    // la cerró en silencio) se reintenta una vez sobre un socket nuevo.
+    int rc = -1;
+    for (int pass = 0; pass < 2; ++pass) {
+        esp_http_client_handle_t cli = slot_client(slot, req->url);
+        if (!cli) { rc = -2; break; }
+        hostinger_lat_begin(&slot->lat, HOSTINGER_LAT_API);
+        if (slot->last_use_us == 0) hostinger_lat_dns(&slot->lat, req->url);   // socket nuevo
+
+        slot->connected_now = false;
+        slot->resp = req->resp;
+        slot->resp_size = req->resp_size;
+        slot->resp_len = 0;
+        if (req->resp && req->resp_size) req->resp[0] = 0;
+        slot->tx_len = 0;
+        esp_http_client_set_header(cli, "Content-Type",
+                                   req->content_type ? req->content_type : "application/json");
+        if (req->content_encoding) esp_http_client_set_header(cli, "Content-Encoding", req->content_encoding);
+        else                       esp_http_client_delete_header(cli, "Content-Encoding");
+
+        // El body va directo al socket: sin copia ni heap por envío
+        esp_err_t err = esp_http_client_open(cli, (int)req->content_length);
+        if (err == ESP_OK) err = req->write_body(req->body_ctx, slot_sink, slot);
+        if (err == ESP_OK) err = slot_flush(slot);
+        if (err == ESP_OK) hostinger_lat_mark_sent(&slot->lat);
+        if (err == ESP_OK && esp_http_client_fetch_headers(cli) < 0) err = ESP_FAIL;
+        if (err == ESP_OK) hostinger_lat_mark_first_byte(&slot->lat);
+        // Consumir la respuesta completa (HTTP_EVENT_ON_DATA la copia a resp)
+        // deja el socket listo para el siguiente request
+        if (err == ESP_OK) err = esp_http_client_flush_response(cli, NULL);
+        bool reused = !slot->connected_now;
+        hostinger_lat_end(&slot->lat, err == ESP_OK);
+
+        if (err == ESP_OK) {
+            int status = esp_http_client_get_status_code(cli);
+            slot->last_use_us = esp_timer_get_time();
+            if (reused) s_stats.reuses++;
+            rc = (status < 200 || status >= 300) ? -100 - status : 0;
+            break;
+        }
+
+        slot_conn_close(slot);
+        if (reused && pass == 0) {
+            s_stats.stale_reconnects++;
+            ESP_LOGW(TAG, "Conexión reutilizada muerta (%s); reconectando",
+                     esp_err_to_name(err));
+            continue;
+        }
+        ESP_LOGE(TAG, "HTTP error: %s", esp_err_to_name(err));
+        rc = (int)err;
+        break;
+    }
+    pool_release(slot);
+    return rc;
+}
+
+typedef struct {
+    const void *body;
+    size_t len;
+} buf_body_t;
+
+static esp_err_t buf_body_write(void *body_ctx, hostinger_http_sink_t sink, void *sink_ctx) {
+    const buf_body_t *b = (const buf_body_t *)body_ctx;
+    return b->len ? sink(sink_ctx, (const uint8_t *)b->body, b->len) : ESP_OK;
+}
+
+int hostinger_http_post_buf(const char *url, const char *content_type,
+                            const void *body, size_t len,
+                            char *resp, size_t resp_size) {
+    buf_body_t b = { .body = body, .len = len };
+    hostinger_http_req_t req = {
+        .url = url,
+        .content_type = content_type,
+        .content_length = len,
+        .write_body = buf_body_write,
+        .body_ctx = &b,
+        .resp = resp,
+        .resp_size = resp_size,
+    };
+    return hostinger_http_post(&req);
+}
+
+void hostinger_http_close_all(void) {
+    if (!pool_init()) return;
+    xSemaphoreTake(s_pool_mtx, portMAX_DELAY);
+    for (int i = 0; i < HOSTINGER_HTTP_POOL_SIZE; ++i) {
+        if (!s_pool[i].busy) slot_conn_close(&s_pool[i]);
+    }
+    xSemaphoreGive(s_pool_mtx);
+}
+
+void hostinger_http_get_stats(hostinger_http_stats_t *out) {
+    if (!out) return;
+    *out = s_stats;
+}
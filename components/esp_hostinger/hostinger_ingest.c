@@ -1,92 +1,276 @@
 #include <string.h>
 #include <stdlib.h>
-#include <stdio.h>
+#include <stdbool.h>
 #include "esp_log.h"
 #include "esp_err.h"
-#include "esp_http_client.h"
-#include "esp_crt_bundle.h"
+#include "esp_timer.h"
 #include "hostinger_ingest.h"
+#include "hostinger_http.h"
+#include "hostinger_gzip.h"
 #include "Privado.h"
 
 static const char* TAG = "HOST_ING";
 
-#define HTTP_BODY_DEBUG 0   // 1 = imprime hasta 256 bytes del body; 0 = apagado
+#define INGEST_RESP_MAX          256   // solo interesa {"accepted":N,"capture":S}
 
-#if HTTP_BODY_DEBUG
-static esp_err_t http_evt(esp_http_client_event_t *evt) {
-    if (evt->event_id == HTTP_EVENT_ON_DATA && evt->data_len > 0) {
-        int n = evt->data_len > 256 ? 256 : evt->data_len;
-        char buf[260]; memcpy(buf, evt->data, n); buf[n] = 0;
-        ESP_LOGW("HTTP_BODY", "%s", buf);
+static hostinger_ingest_stats_t s_stats;
+
+// Compresión gzip del body (NULL = desactivada). El estado (~3 KB) se reserva
+// una sola vez al activarla y se reutiliza en cada envío.
+static hostinger_gzip_t *s_gz = NULL;
+static size_t s_gz_min_bytes = 0;
+
+// Inicio de la respuesta del servidor (truncada)
+static char s_resp[INGEST_RESP_MAX];
+
+// Segundos de captura cruda pedidos por el servidor ("capture":S), hasta
+// que la aplicación los toma
+static uint32_t s_capture_req = 0;
+
+// ---------- Body por fragmentos ----------
+// El body se describe (no se arma): se emite en fragmentos hacia un destino
+// (contador, gzip o el socket) sin copiarlo a un buffer intermedio.
+typedef hostinger_http_sink_t ingest_sink_t;
+
+typedef struct {
+    const char* const* rows;        // filas JSON (NULL = body crudo)
+    int n_rows;
+    bool batch;                     // envolver como lote según fmt
+    hostinger_batch_format_t fmt;
+    const void* raw;                // body ya codificado, se envía tal cual
+    size_t raw_len;
+} ingest_body_t;
+
+static esp_err_t emit(ingest_sink_t sink, void* ctx, const char* s, size_t n) {
+    return n ? sink(ctx, (const uint8_t*)s, n) : ESP_OK;
+}
+
+#define EMIT_STR(sink, ctx, s) emit(sink, ctx, s, strlen(s))
+
+// Una fila con device_id inyectado si no lo trae
+static esp_err_t emit_row(const char* row, ingest_sink_t sink, void* ctx) {
+    if (!row) row = "{}";
+    esp_err_t err;
+    if (strstr(row, "\"device_id\"")) {
+        return EMIT_STR(sink, ctx, row);
     }
-    return ESP_OK;
+    if (row[0] == '{' && row[1]) {
+        if ((err = EMIT_STR(sink, ctx, "{\"device_id\":\"")) != ESP_OK) return err;
+        if ((err = EMIT_STR(sink, ctx, DEVICE_ID)) != ESP_OK) return err;
+        if ((err = EMIT_STR(sink, ctx, "\",")) != ESP_OK) return err;
+        return EMIT_STR(sink, ctx, row + 1);
+    }
+    if ((err = EMIT_STR(sink, ctx, "{\"device_id\":\"")) != ESP_OK) return err;
+    if ((err = EMIT_STR(sink, ctx, DEVICE_ID)) != ESP_OK) return err;
+    if ((err = EMIT_STR(sink, ctx, "\",\"raw\":\"")) != ESP_OK) return err;
+    if ((err = EMIT_STR(sink, ctx, row)) != ESP_OK) return err;
+    return EMIT_STR(sink, ctx, "\"}");
 }
-#endif
-
-// Si el JSON no trae "device_id", lo inyectamos.
-static char* ensure_device_id(const char* body_in) {
-    if (!body_in) body_in = "{}";
-    size_t n = strlen(body_in);
-    if (strstr(body_in, "\"device_id\"")) { // ya lo trae
-        char* out = (char*)malloc(n + 1);
-        if (!out) return NULL;
-        memcpy(out, body_in, n + 1);
-        return out;
+
+static esp_err_t emit_body(const ingest_body_t* b, ingest_sink_t sink, void* ctx) {
+    if (!b->rows) return emit(sink, ctx, (const char*)b->raw, b->raw_len);
+    if (!b->batch) return emit_row(b->rows[0], sink, ctx);
+
+    bool arr = (b->fmt == HOSTINGER_BATCH_JSON_ARRAY);
+    esp_err_t err = arr ? emit(sink, ctx, "[", 1) : ESP_OK;
+    for (int i = 0; i < b->n_rows && err == ESP_OK; ++i) {
+        if (i > 0 && arr) err = emit(sink, ctx, ",", 1);
+        if (err == ESP_OK) err = emit_row(b->rows[i], sink, ctx);
+        if (err == ESP_OK && !arr) err = emit(sink, ctx, "\n", 1);
     }
-    if (n > 1 && body_in[0] == '{') {
-        const char* rest = body_in + 1;
-        size_t extra = strlen(DEVICE_ID) + 32;
-        char* out = (char*)malloc(n + extra);
-        if (!out) return NULL;
-        int w = snprintf(out, n + extra, "{\"device_id\":\"%s\",%s", DEVICE_ID, rest);
-        if (w < 0) { free(out); return NULL; }
-        return out;
+    if (err == ESP_OK && arr) err = emit(sink, ctx, "]", 1);
+    return err;
+}
+
+// Contador de bytes con tope opcional (cap = 0: sin tope)
+typedef struct {
+    size_t len;
+    size_t cap;
+} count_sink_t;
+
+static esp_err_t count_sink(void *ctx, const uint8_t *data, size_t len) {
+    count_sink_t *c = (count_sink_t *)ctx;
+    (void)data;
+    c->len += len;
+    return (c->cap && c->len >= c->cap) ? ESP_ERR_NO_MEM : ESP_OK;
+}
+
+static size_t body_len(const ingest_body_t* b) {
+    count_sink_t c = { 0 };
+    emit_body(b, count_sink, &c);
+    return c.len;
+}
+
+static esp_err_t gzip_sink(void *ctx, const uint8_t *data, size_t len) {
+    return hostinger_gzip_write((hostinger_gzip_t *)ctx, data, len);
+}
+
+// Comprime el body hacia sink (el compresor solo guarda su ventana)
+static esp_err_t gzip_emit(const ingest_body_t* b, ingest_sink_t sink, void* ctx) {
+    hostinger_gzip_init(s_gz, sink, ctx);
+    esp_err_t err = emit_body(b, gzip_sink, s_gz);
+    if (err == ESP_OK) err = hostinger_gzip_finish(s_gz);
+    return err;
+}
+
+// Primera pasada de gzip solo para conocer el Content-Length. 0 si está
+// desactivado, el body es chico o no resultaría menor (se envía tal cual).
+static size_t gzip_len(const ingest_body_t* b, size_t raw_len) {
+    if (!s_gz || raw_len < s_gz_min_bytes) return 0;
+
+    count_sink_t c = { .len = 0, .cap = raw_len };
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = gzip_emit(b, count_sink, &c);
+    int64_t us = esp_timer_get_time() - t0;
+
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "gzip no reduce %u bytes (%lld us); se envía sin comprimir",
+                 (unsigned)raw_len, (long long)us);
+        return 0;
     }
-    size_t rawlen = strlen(body_in);
-    size_t extra = strlen(DEVICE_ID) + rawlen + 64;
-    char* out = (char*)malloc(extra);
-    if (!out) return NULL;
-    int w = snprintf(out, extra, "{\"device_id\":\"%s\",\"raw\":\"%s\"}", DEVICE_ID, body_in);
-    if (w < 0) { free(out); return NULL; }
-    return out;
-}
-
-static int do_post_json(const char* url, const char* json_body) {
-    esp_http_client_config_t cfg = {
-        .url = url,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-        .timeout_ms = 15000,
-        .disable_auto_redirect = true,
-    #if HTTP_BODY_DEBUG
-        .event_handler = http_evt,
-    #endif
-    
-    };
-    esp_http_client_handle_t cli = esp_http_client_init(&cfg);
-    if (!cli) return -2;
+    s_stats.gzip_in += (uint32_t)raw_len;
+    s_stats.gzip_out += (uint32_t)c.len;
+    ESP_LOGI(TAG, "gzip %u -> %u bytes (%u%%) en %lld us",
+             (unsigned)raw_len, (unsigned)c.len, (unsigned)(c.len * 100 / raw_len),
+             (long long)us);
+    return c.len;
+}
+
+typedef struct {
+    const ingest_body_t* body;
+    bool gzip;
+} ingest_write_t;
 
-    esp_http_client_set_method(cli, HTTP_METHOD_POST);
-    esp_http_client_set_header(cli, "Content-Type", "application/json");
-    esp_http_client_set_header(cli, "X-API-Key", HOSTINGER_API_KEY);
-    esp_http_client_set_header(cli, "Connection", "close");
-    esp_http_client_set_post_field(cli, json_body, strlen(json_body));
+static esp_err_t ingest_write_body(void* body_ctx, hostinger_http_sink_t sink, void* sink_ctx) {
+    const ingest_write_t* w = (const ingest_write_t*)body_ctx;
+    return w->gzip ? gzip_emit(w->body, sink, sink_ctx) : emit_body(w->body, sink, sink_ctx);
+}
+
+static int do_post(const ingest_body_t* b, const char* content_type, size_t* sent_len) {
+    size_t len = body_len(b);
+    size_t gz_len = gzip_len(b, len);
+    if (sent_len) *sent_len = len;
 
-    esp_err_t err = esp_http_client_perform(cli);
-    int status = -1;
-    if (err == ESP_OK) status = esp_http_client_get_status_code(cli);
-    else ESP_LOGE(TAG, "HTTP error: %s", esp_err_to_name(err));
+    ingest_write_t w = { .body = b, .gzip = gz_len > 0 };
+    hostinger_http_req_t req = {
+        .url = HOSTINGER_URL_INGEST,
+        .content_type = content_type,
+        .content_encoding = gz_len ? "gzip" : NULL,
+        .content_length = gz_len ? gz_len : len,
+        .write_body = ingest_write_body,
+        .body_ctx = &w,
+        .resp = s_resp,
+        .resp_size = sizeof(s_resp),
+    };
+    s_resp[0] = '\0';
+    int rc = hostinger_http_post(&req);
+    if (rc == 0) {
+        const char* p = strstr(s_resp, "\"capture\":");
+        if (p) {
+            long secs = atol(p + strlen("\"capture\":"));
+            if (secs > 0 && (uint32_t)secs > s_capture_req) s_capture_req = (uint32_t)secs;
+        }
+    }
+    return rc;
+}
 
-    esp_http_client_cleanup(cli);
-    if (err != ESP_OK) return (int)err;
-    if (status < 200 || status >= 300) return -100 - status;
-    return 0;
+static void log_conn_stats(int rc) {
+    hostinger_http_stats_t hs;
+    hostinger_http_get_stats(&hs);
+    ESP_LOGI(TAG, "INGEST => %d (conexiones=%u reusos=%u)",
+             rc, (unsigned)hs.connects, (unsigned)hs.reuses);
 }
 
 int hostinger_ingest_post(const char* json_utf8) {
-    char* body = ensure_device_id(json_utf8);
-    if (!body) return -1;
-    int rc = do_post_json(HOSTINGER_URL_INGEST, body);
-    free(body);
-    ESP_LOGI(TAG, "INGEST => %d", rc);
+    const char* row = json_utf8;
+    ingest_body_t b = { .rows = &row, .n_rows = 1 };
+    s_stats.posts++;
+    int rc = do_post(&b, "application/json", NULL);
+    log_conn_stats(rc);
     return rc;
 }
+
+int hostinger_ingest_post_raw(const void* body, size_t len, const char* content_type) {
+    if (!body || len == 0 || !content_type) return -1;
+    ingest_body_t b = { .raw = body, .raw_len = len };
+    s_stats.posts++;
+    int rc = do_post(&b, content_type, NULL);
+    ESP_LOGI(TAG, "INGEST %s %u bytes", content_type, (unsigned)len);
+    log_conn_stats(rc);
+    return rc;
+}
+
+int hostinger_ingest_post_batch(const char* const* rows, int n_rows,
+                                hostinger_batch_format_t fmt, size_t max_bytes,
+                                int* accepted) {
+    if (accepted) *accepted = 0;
+    if (!rows || n_rows <= 0) return -1;
+
+    // Cuántas filas caben en max_bytes (al menos una, aunque la exceda)
+    size_t total = 2;   // "[" "]" o margen para NDJSON
+    int n = 0;
+    for (; n < n_rows; ++n) {
+        count_sink_t c = { 0 };
+        emit_row(rows[n], count_sink, &c);
+        size_t next = total + c.len + 1;
+        if (n > 0 && max_bytes > 0 && next > max_bytes) break;
+        total = next;
+    }
+
+    ingest_body_t b = { .rows = rows, .n_rows = n, .batch = true, .fmt = fmt };
+    size_t used = 0;
+    s_stats.batch_posts++;
+    int rc = do_post(&b, fmt == HOSTINGER_BATCH_NDJSON ? "application/x-ndjson"
+                                                       : "application/json", &used);
+
+    int ok_rows = 0;
+    if (rc == 0) {
+        // {"accepted":N} = primeras N filas guardadas; sin campo, 2xx = todas
+        const char* p = strstr(s_resp, "\"accepted\":");
+        ok_rows = p ? atoi(p + strlen("\"accepted\":")) : n;
+        if (ok_rows < 0) ok_rows = 0;
+        if (ok_rows > n) ok_rows = n;
+        s_stats.batch_rows += (uint32_t)ok_rows;
+    }
+    if (accepted) *accepted = ok_rows;
+
+    ESP_LOGI(TAG, "INGEST batch %d filas (%u bytes) => %d, aceptadas=%d",
+             n, (unsigned)used, rc, ok_rows);
+    return rc;
+}
+
+esp_err_t hostinger_ingest_set_gzip(size_t min_bytes) {
+    if (min_bytes == 0) {
+        free(s_gz);
+        s_gz = NULL;
+        return ESP_OK;
+    }
+    if (!s_gz) {
+        s_gz = (hostinger_gzip_t*)malloc(sizeof(*s_gz));
+        if (!s_gz) return ESP_ERR_NO_MEM;
+    }
+    s_gz_min_bytes = min_bytes;
+    ESP_LOGI(TAG, "gzip activo para bodies >= %u bytes (estado %u bytes)",
+             (unsigned)min_bytes, (unsigned)sizeof(*s_gz));
+    return ESP_OK;
+}
+
+void hostinger_ingest_close(void) {
+    hostinger_http_close_all();
+}
+
+uint32_t hostinger_ingest_take_capture_request(void) {
+    uint32_t secs = s_capture_req;
+    s_capture_req = 0;
+    return secs;
+}
+
+void hostinger_ingest_get_stats(hostinger_ingest_stats_t *out) {
+    if (!out) return;
+    hostinger_http_stats_t hs;
+    hostinger_http_get_stats(&hs);
+    *out = s_stats;
+    out->connects = hs.connects;
+    out->reuses = hs.reuses;
+    out->stale_reconnects = hs.stale_reconnects;
+}
@@ -0,0 +1,231 @@
+#include <string.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/netdb.h"
+#include "hostinger_latency.h"
+
+static const char* TAG = "HOST_LAT";
+
+#define LAT_BUCKET0_MS   8
+#define LAT_HOST_MAX     64
+
+static const char *const s_ch_name[HOSTINGER_LAT_CHANNELS] = { "api", "ota", "geo" };
+static const char *const s_ph_name[HOSTINGER_LAT_PHASES] = { "dns", "con", "snd", "ttfb", "body", "tot" };
+
+static hostinger_lat_hist_t s_hist[HOSTINGER_LAT_CHANNELS][HOSTINGER_LAT_PHASES];
+static uint32_t s_requests[HOSTINGER_LAT_CHANNELS];    // dentro de la ventana móvil
+static uint32_t s_failures[HOSTINGER_LAT_CHANNELS];    // de esos, los fallidos
+static portMUX_TYPE s_lat_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static int lat_bucket(uint32_t ms) {
+    int b = 0;
+    uint32_t edge = LAT_BUCKET0_MS;
+    while (b < HOSTINGER_LAT_BUCKETS - 1 && ms >= edge) {
+        b++;
+        edge <<= 1;
+    }
+    return b;
+}
+
+// Límite superior del bucket (el último no tiene: se informa su inicio)
+static uint32_t lat_bucket_ms(int b) {
+    if (b >= HOSTINGER_LAT_BUCKETS - 1) return (uint32_t)LAT_BUCKET0_MS << (HOSTINGER_LAT_BUCKETS - 2);
+    return (uint32_t)LAT_BUCKET0_MS << b;
+}
+
+static void lat_record(hostinger_lat_channel_t ch, hostinger_lat_phase_t ph, int64_t us) {
+    if (us < 0) return;
+    uint32_t ms = (uint32_t)(us / 1000);
+    hostinger_lat_hist_t *h = &s_hist[ch][ph];
+    int b = lat_bucket(ms);
+    if (h->bucket[b] < UINT16_MAX) h->bucket[b]++;
+    h->last_ms = ms;
+    if (ms > h->max_ms) h->max_ms = ms;
+}
+
+// Envejece el canal: la mitad del peso para lo anterior a la ventana
+static void lat_decay(hostinger_lat_channel_t ch) {
+    for (int ph = 0; ph < HOSTINGER_LAT_PHASES; ++ph) {
+        hostinger_lat_hist_t *h = &s_hist[ch][ph];
+        for (int b = 0; b < HOSTINGER_LAT_BUCKETS; ++b) h->bucket[b] >>= 1;
+        h->max_ms = h->last_ms;
+    }
+    s_requests[ch] >>= 1;
+    s_failures[ch] >>= 1;
+}
+
+void hostinger_lat_begin(hostinger_lat_probe_t *p, hostinger_lat_channel_t ch) {
+    if (!p) return;
+    memset(p, 0, sizeof(*p));
+    p->ch = ch < HOSTINGER_LAT_CHANNELS ? ch : HOSTINGER_LAT_API;
+    p->dns_us = -1;
+    p->t_start = esp_timer_get_time();
+}
+
+void hostinger_lat_dns(hostinger_lat_probe_t *p, const char *url) {
+    if (!p || !url) return;
+    const char *h = strstr(url, "://");
+    h = h ? h + 3 : url;
+    char host[LAT_HOST_MAX];
+    size_t n = strcspn(h, ":/?#");
+    if (n == 0 || n >= sizeof(host)) return;
+    memcpy(host, h, n);
+    host[n] = 0;
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    int64_t t0 = esp_timer_get_time();
+    int rc = getaddrinfo(host, NULL, &hints, &res);
+    int64_t t1 = esp_timer_get_time();
+    if (res) freeaddrinfo(res);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "DNS %s falló (%d) en %lld ms", host, rc, (long long)((t1 - t0) / 1000));
+        return;
+    }
+    p->dns_us = t1 - t0;
+    p->t_start = t1;    // el resto de fases se mide después de resolver
+}
+
+void hostinger_lat_event(hostinger_lat_probe_t *p, const esp_http_client_event_t *evt) {
+    if (!p || !evt || !p->t_start) return;
+    switch (evt->event_id) {
+    case HTTP_EVENT_ON_CONNECTED:
+        p->t_conn = esp_timer_get_time();
+        break;
+    case HTTP_EVENT_HEADERS_SENT:
+        if (!p->t_sent) p->t_sent = esp_timer_get_time();
+        break;
+    case HTTP_EVENT_ON_HEADER:
+    case HTTP_EVENT_ON_DATA:
+        if (!p->t_first) p->t_first = esp_timer_get_time();
+        break;
+    default:
+        break;
+    }
+}
+
+void hostinger_lat_mark_sent(hostinger_lat_probe_t *p) {
+    if (p) p->t_sent = esp_timer_get_time();
+}
+
+void hostinger_lat_mark_first_byte(hostinger_lat_probe_t *p) {
+    if (p && !p->t_first) p->t_first = esp_timer_get_time();
+}
+
+void hostinger_lat_end(hostinger_lat_probe_t *p, bool ok) {
+    if (!p || !p->t_start) return;
+    int64_t t_end = esp_timer_get_time();
+    // Sin conexión nueva el envío arranca en t_start
+    int64_t t_ready = p->t_conn ? p->t_conn : p->t_start;
+    int64_t t_sent = p->t_sent ? p->t_sent : t_ready;
+    int64_t t_first = p->t_first ? p->t_first : t_end;
+    int64_t total = t_end - p->t_start + (p->dns_us > 0 ? p->dns_us : 0);
+
+    portENTER_CRITICAL(&s_lat_mux);
+    if (s_requests[p->ch] >= HOSTINGER_LAT_WINDOW) lat_decay(p->ch);
+    s_requests[p->ch]++;
+    if (!ok) s_failures[p->ch]++;
+    if (p->dns_us >= 0) lat_record(p->ch, HOSTINGER_LAT_DNS, p->dns_us);
+    if (p->t_conn) lat_record(p->ch, HOSTINGER_LAT_CONNECT, p->t_conn - p->t_start);
+    if (ok) {
+        lat_record(p->ch, HOSTINGER_LAT_SEND, t_sent - t_ready);
+        lat_record(p->ch, HOSTINGER_LAT_TTFB, t_first - t_sent);
+        lat_record(p->ch, HOSTINGER_LAT_BODY, t_end - t_first);
+    } else {
+        // Fallido: solo las fases que llegaron a completarse; el total
+        // (hasta el error o timeout) va siempre, que es la cola lenta
+        if (p->t_sent) lat_record(p->ch, HOSTINGER_LAT_SEND, t_sent - t_ready);
+        if (p->t_sent && p->t_first) lat_record(p->ch, HOSTINGER_LAT_TTFB, t_first - t_sent);
+    }
+    lat_record(p->ch, HOSTINGER_LAT_TOTAL, total);
+    portEXIT_CRITICAL(&s_lat_mux);
+
+    ESP_LOGD(TAG, "%s%s dns=%lld con=%lld snd=%lld ttfb=%lld body=%lld tot=%lld ms",
+             s_ch_name[p->ch], ok ? "" : " FALLO",
+             (long long)(p->dns_us >= 0 ? p->dns_us / 1000 : -1),
+             (long long)(p->t_conn ? (p->t_conn - p->t_start) / 1000 : -1),
+             (long long)((t_sent - t_ready) / 1000), (long long)((t_first - t_sent) / 1000),
+             (long long)((t_end - t_first) / 1000), (long long)(total / 1000));
+    p->t_start = 0;
+}
+
+void hostinger_lat_get(hostinger_lat_channel_t ch, hostinger_lat_phase_t ph, hostinger_lat_hist_t *out) {
+    if (!out || ch >= HOSTINGER_LAT_CHANNELS || ph >= HOSTINGER_LAT_PHASES) return;
+    portENTER_CRITICAL(&s_lat_mux);
+    *out = s_hist[ch][ph];
+    portEXIT_CRITICAL(&s_lat_mux);
+}
+
+uint32_t hostinger_lat_requests(hostinger_lat_channel_t ch) {
+    return ch < HOSTINGER_LAT_CHANNELS ? s_requests[ch] : 0;
+}
+
+uint32_t hostinger_lat_failures(hostinger_lat_channel_t ch) {
+    return ch < HOSTINGER_LAT_CHANNELS ? s_failures[ch] : 0;
+}
+
+uint32_t hostinger_lat_percentile_ms(hostinger_lat_channel_t ch, hostinger_lat_phase_t ph, int pct) {
+    hostinger_lat_hist_t h = { 0 };
+    hostinger_lat_get(ch, ph, &h);
+    uint32_t total = 0;
+    for (int b = 0; b < HOSTINGER_LAT_BUCKETS; ++b) total += h.bucket[b];
+    if (total == 0) return 0;
+
+    uint32_t target = (total * (uint32_t)pct + 99) / 100;
+    uint32_t acc = 0;
+    for (int b = 0; b < HOSTINGER_LAT_BUCKETS; ++b) {
+        acc += h.bucket[b];
+        if (acc >= target) return lat_bucket_ms(b);
+    }
+    return lat_bucket_ms(HOSTINGER_LAT_BUCKETS - 1);
+}
+
+void hostinger_lat_log(void) {
+    for (int ch = 0; ch < HOSTINGER_LAT_CHANNELS; ++ch) {
+        if (!s_requests[ch]) continue;
+        char line[160];
+        int n = 0;
+        for (int ph = 0; ph < HOSTINGER_LAT_PHASES && n < (int)sizeof(line); ++ph) {
+            n += snprintf(line + n, sizeof(line) - n, " %s<=%u/%u",
+                          s_ph_name[ph],
+                          (unsigned)hostinger_lat_percentile_ms(ch, ph, 50),
+                          (unsigned)hostinger_lat_percentile_ms(ch, ph, 90));
+        }
+        ESP_LOGI(TAG, "%s n=%u err=%u p50/p90 ms:%s", s_ch_name[ch], (unsigned)s_requests[ch],
+                 (unsigned)s_failures[ch], line);
+    }
+}
+
+int hostinger_lat_format_json(char *buf, size_t len) {
+    if (!buf || len < 3) return -1;
+    size_t n = 0;
+    int w;
+    bool first_ch = true;
+    buf[n++] = '{';
+    for (int ch = 0; ch < HOSTINGER_LAT_CHANNELS; ++ch) {
+        if (!s_requests[ch]) continue;
+        w = snprintf(buf + n, len - n, "%s\"%s\":{\"n\":%u,\"err\":%u", first_ch ? "" : ",",
+                     s_ch_name[ch], (unsigned)s_requests[ch], (unsigned)s_failures[ch]);
+        if (w < 0 || (size_t)w >= len - n) return -1;
+        n += (size_t)w;
+        first_ch = false;
+        for (int ph = 0; ph < HOSTINGER_LAT_PHASES; ++ph) {
+            hostinger_lat_hist_t h;
+            hostinger_lat_get(ch, ph, &h);
+            w = snprintf(buf + n, len - n, ",\"%s\":[%u,%u,%u]", s_ph_name[ph],
+                         (unsigned)hostinger_lat_percentile_ms(ch, ph, 50),
+                         (unsigned)hostinger_lat_percentile_ms(ch, ph, 90),
+                         (unsigned)h.max_ms);
+            if (w < 0 || (size_t)w >= len - n) return -1;
+            n += (size_t)w;
+        }
+        if (n + 1 >= len) return -1;
+        buf[n++] = '}';
+    }
+    if (n + 1 >= len) return -1;
+    buf[n++] = '}';
+    buf[n] = 0;
+    return (int)n;
+}
@@ -0,0 +1,13 @@
+#include "sdkconfig.h"
+#include "esp_crt_bundle.h"
+#include "hostinger_tls.h"
+
+void hostinger_tls_apply(esp_http_client_config_t *cfg) {
+    if (!cfg) return;
+    cfg->crt_bundle_attach = esp_crt_bundle_attach;
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    // El transporte SSL guarda el ticket/ID de sesión tras el primer
+    // handshake y lo presenta en cada reconexión del mismo handle.
+    cfg->save_client_session = true;
+#endif
+}
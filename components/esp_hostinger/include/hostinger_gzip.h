@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compresor gzip (RFC 1952) en streaming con RAM acotada: LZ77 con ventana de
+// HOSTINGER_GZIP_WINDOW bytes y códigos Huffman fijos de deflate. No alcanza la
+// razón de zlib, pero el JSON repetitivo de las ventanas comprime bien y el
+// estado completo cabe en ~3 KB (el deflate de ROM necesita cientos de KB).
+
+#define HOSTINGER_GZIP_WINDOW     1024
+#define HOSTINGER_GZIP_HASH_BITS  9
+
+// Recibe la salida comprimida por fragmentos
+typedef esp_err_t (*hostinger_gzip_sink_t)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct {
+    hostinger_gzip_sink_t sink;
+    void *sink_ctx;
+    uint8_t  win[2 * HOSTINGER_GZIP_WINDOW];   // historia + anticipo
+    int16_t  head[1 << HOSTINGER_GZIP_HASH_BITS];
+    size_t   pos;        // siguiente byte a codificar dentro de win
+    size_t   end;        // bytes válidos en win
+    uint32_t bitbuf;
+    int      bitcnt;
+    uint8_t  out[64];
+    size_t   out_len;
+    uint32_t crc;
+    uint32_t in_total;
+    uint32_t out_total;
+    esp_err_t err;
+} hostinger_gzip_t;
+
+void hostinger_gzip_init(hostinger_gzip_t *z, hostinger_gzip_sink_t sink, void *ctx);
+
+// Alimenta datos sin comprimir (cualquier tamaño de fragmento)
+esp_err_t hostinger_gzip_write(hostinger_gzip_t *z, const void *data, size_t len);
+
+// Codifica lo pendiente y escribe el trailer gzip (CRC32 + tamaño)
+esp_err_t hostinger_gzip_finish(hostinger_gzip_t *z);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Transporte HTTP(S) común de esp_hostinger: un pool chico de clientes
+// keep-alive por host, con headers (X-API-Key), timeouts, TLS y mapeo de
+// errores compartidos. Ingest y admin al mismo host reutilizan el socket.
+
+#define HOSTINGER_HTTP_POOL_SIZE  2
+
+// Destino de un fragmento del body
+typedef esp_err_t (*hostinger_http_sink_t)(void *ctx, const uint8_t *data, size_t len);
+
+// Escribe el body completo en sink; se invoca una vez por intento
+typedef esp_err_t (*hostinger_http_body_fn)(void *body_ctx, hostinger_http_sink_t sink, void *sink_ctx);
+
+typedef struct {
+    const char *url;
+    const char *content_type;
+    const char *content_encoding;   // NULL = sin Content-Encoding
+    size_t content_length;          // bytes exactos que escribe write_body
+    hostinger_http_body_fn write_body;
+    void *body_ctx;
+    char *resp;                     // inicio de la respuesta (opcional, terminada en 0)
+    size_t resp_size;
+} hostinger_http_req_t;
+
+typedef struct {
+    uint32_t requests;
+    uint32_t connects;          // handshakes TCP+TLS realizados
+    uint32_t reuses;            // requests sobre una conexión ya abierta
+    uint32_t stale_reconnects;  // conexiones reutilizadas halladas muertas
+    uint32_t pool_waits;        // requests que esperaron un cliente libre
+} hostinger_http_stats_t;
+
+// POST. Devuelve 0 en 2xx, -100-status en otro HTTP, el esp_err_t del
+// transporte si falla la conexión y -2 si no hay cliente disponible.
+int hostinger_http_post(const hostinger_http_req_t *req);
+
+// POST de un body ya armado en memoria
+int hostinger_http_post_buf(const char *url, const char *content_type,
+                            const void *body, size_t len,
+                            char *resp, size_t resp_size);
+
+// Cierra los sockets del pool (p.ej. al caer PPP); los handles y sus
+// sesiones TLS se conservan para reanudarlas al reconectar
+void hostinger_http_close_all(void);
+
+void hostinger_http_get_stats(hostinger_http_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
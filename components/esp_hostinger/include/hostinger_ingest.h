@@ -1,17 +1,73 @@
 #pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Contadores de ingest (los de conexión son del pool HTTP compartido)
+typedef struct {
+    uint32_t posts;             // llamadas a hostinger_ingest_post
+    uint32_t connects;          // handshakes TCP+TLS realizados
+    uint32_t reuses;            // envíos que reutilizaron la conexión abierta
+    uint32_t stale_reconnects;  // conexiones reutilizadas halladas muertas
+    uint32_t batch_posts;       // requests por lotes
+    uint32_t batch_rows;        // filas aceptadas en lotes
+    uint32_t gzip_in;           // bytes antes de comprimir (solo bodies comprimidos)
+    uint32_t gzip_out;          // bytes gzip enviados
+} hostinger_ingest_stats_t;
+
+// Formato del body de un lote
+typedef enum {
+    HOSTINGER_BATCH_JSON_ARRAY = 0,   // [{...},{...}]         application/json
+    HOSTINGER_BATCH_NDJSON,           // {...}\n{...}\n       application/x-ndjson
+} hostinger_batch_format_t;
+
 // Envío de lecturas (equivale a firebase_putData/postData)
 int hostinger_ingest_post(const char* json_utf8);
 
+// Envía un body ya codificado (p.ej. CBOR) tal cual; debe traer device_id.
+int hostinger_ingest_post_raw(const void* body, size_t len, const char* content_type);
+
+// Envía varias ventanas en un solo request. Solo entran las primeras filas que
+// quepan en max_bytes (0 = sin tope; siempre al menos una). El servidor responde
+// {"accepted":N} = primeras N filas guardadas en orden; si no lo informa y
+// responde 2xx se asumen todas las enviadas. *accepted recibe ese N.
+int hostinger_ingest_post_batch(const char* const* rows, int n_rows,
+                                hostinger_batch_format_t fmt, size_t max_bytes,
+                                int* accepted);
+
+// Comprime con gzip (Content-Encoding: gzip) los bodies de al menos min_bytes;
+// 0 = desactivado. Si el resultado no es menor se envía sin comprimir.
+// El servidor debe descomprimir el request (p.ej. gzdecode en PHP).
+esp_err_t hostinger_ingest_set_gzip(size_t min_bytes);
+
+// Cierra los sockets del pool HTTP (p.ej. al caer PPP); las sesiones TLS
+// se conservan para reanudarlas en la siguiente conexión
+void hostinger_ingest_close(void);
+
+// Segundos de captura cruda que pidió el servidor en alguna respuesta de
+// ingest ({"capture":S}) desde la última llamada; 0 = ninguno. Lo consume.
+uint32_t hostinger_ingest_take_capture_request(void);
+
+// Copia los contadores de conexión/reuso
+void hostinger_ingest_get_stats(hostinger_ingest_stats_t *out);
+
 // Admin (replica "delete on boot" de Firebase)
 int hostinger_delete_all_for_device(const char* device_id);
 
 // Admin (replica trim_oldest_batch de Firebase)
 int hostinger_trim_oldest_batch(const char* device_id, int batch_size);
 
+// Admin: envía el resumen de latencias HTTP (ver hostinger_latency.h)
+int hostinger_post_latency_telemetry(const char* device_id);
+
+// Igual, agregando al body los pares "clave":valor de extra (sin llaves),
+// p.ej. "\"sensors\":{...}"; NULL = solo latencias
+int hostinger_post_telemetry(const char* device_id, const char* extra);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,86 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Desglose de latencia por request HTTP(S) en histogramas móviles.
+// Fases: DNS, conexión (TCP+TLS: esp_http_client no separa el handshake del
+// connect), envío del request, espera del primer byte (TTFB), lectura del
+// body y total. Las fases de conexión y DNS solo se registran cuando el
+// request abrió socket nuevo. Los requests fallidos (error o timeout) se
+// cuentan aparte y registran el total y las fases que alcanzaron.
+
+typedef enum {
+    HOSTINGER_LAT_API = 0,   // ingest/admin (pool de hostinger_http)
+    HOSTINGER_LAT_OTA,       // manifest + imagen OTA
+    HOSTINGER_LAT_GEO,       // UnwiredLabs
+    HOSTINGER_LAT_CHANNELS
+} hostinger_lat_channel_t;
+
+typedef enum {
+    HOSTINGER_LAT_DNS = 0,
+    HOSTINGER_LAT_CONNECT,
+    HOSTINGER_LAT_SEND,
+    HOSTINGER_LAT_TTFB,
+    HOSTINGER_LAT_BODY,
+    HOSTINGER_LAT_TOTAL,
+    HOSTINGER_LAT_PHASES
+} hostinger_lat_phase_t;
+
+// Buckets log2 en ms: [0,8) [8,16) ... [8192,16384) [16384,inf)
+#define HOSTINGER_LAT_BUCKETS   12
+// Al llegar a tantos requests en un canal, los conteos se reducen a la mitad
+#define HOSTINGER_LAT_WINDOW    64
+
+typedef struct {
+    uint16_t bucket[HOSTINGER_LAT_BUCKETS];
+    uint32_t last_ms;
+    uint32_t max_ms;
+} hostinger_lat_hist_t;
+
+// Marcas de tiempo de un request en curso (esp_timer, us; 0 = no ocurrió)
+typedef struct {
+    hostinger_lat_channel_t ch;
+    int64_t t_start;
+    int64_t t_conn;
+    int64_t t_sent;
+    int64_t t_first;
+    int64_t dns_us;     // -1 = no medido
+} hostinger_lat_probe_t;
+
+void hostinger_lat_begin(hostinger_lat_probe_t *p, hostinger_lat_channel_t ch);
+
+// Resuelve el host de la URL midiendo el tiempo; deja la respuesta en la
+// caché DNS de lwip, así la resolución interna del cliente sale de ahí.
+void hostinger_lat_dns(hostinger_lat_probe_t *p, const char *url);
+
+// Llamar desde el event handler del cliente: marca conexión, envío y primer byte
+void hostinger_lat_event(hostinger_lat_probe_t *p, const esp_http_client_event_t *evt);
+
+// Marcas explícitas para clientes que usan open/write/fetch_headers
+void hostinger_lat_mark_sent(hostinger_lat_probe_t *p);
+void hostinger_lat_mark_first_byte(hostinger_lat_probe_t *p);
+
+// Cierra el request y vuelca las fases a los histogramas; ok = false lo
+// cuenta como fallido
+void hostinger_lat_end(hostinger_lat_probe_t *p, bool ok);
+
+// Consultas locales
+void hostinger_lat_get(hostinger_lat_channel_t ch, hostinger_lat_phase_t ph, hostinger_lat_hist_t *out);
+uint32_t hostinger_lat_requests(hostinger_lat_channel_t ch);   // incluye fallidos
+uint32_t hostinger_lat_failures(hostinger_lat_channel_t ch);
+uint32_t hostinger_lat_percentile_ms(hostinger_lat_channel_t ch, hostinger_lat_phase_t ph, int pct);
+void hostinger_lat_log(void);
+
+// Registro compacto de telemetría: {"api":{"n":N,"err":E,"dns":[p50,p90,max],...},...}
+// Devuelve los bytes escritos (sin el 0) o -1 si no cabe.
+int hostinger_lat_format_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+#include "esp_http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Aplica la config TLS común (bundle de CAs + reanudación de sesión) a un
+// cliente HTTPS. El ticket vive dentro del handle, así que solo sirve en
+// clientes de larga vida: el pool de hostinger_http (ingest y admin). OTA y
+// UnwiredLabs crean y destruyen su cliente en cada llamada y no lo usan.
+void hostinger_tls_apply(esp_http_client_config_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#include "epoch_time.h"
+
+#include <stdio.h>
+
+#define SECONDS_PER_DAY 86400
+
+static int64_t local_seconds(uint32_t epoch)
+{
+    return (int64_t)epoch + EPOCH_UTC_OFFSET_S;
+}
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+int32_t epoch_local_day(uint32_t epoch)
+{
+    return (int32_t)floor_div(local_seconds(epoch), SECONDS_PER_DAY);
+}
+
+void epoch_format_hms(uint32_t epoch, char *out, size_t len)
+{
+    int64_t s = local_seconds(epoch) - (int64_t)epoch_local_day(epoch) * SECONDS_PER_DAY;
+    snprintf(out, len, "%02d:%02d:%02d",
+             (int)(s / 3600), (int)(s / 60 % 60), (int)(s % 60));
+}
+
+// Días desde 1970-01-01 -> fecha civil (algoritmo de H. Hinnant)
+static void civil_from_days(int32_t z, int *y, unsigned *m, unsigned *d)
+{
+    z += 719468;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int)yoe + era * 400 + (*m <= 2);
+}
+
+void epoch_format_dmy(uint32_t epoch, char *out, size_t len)
+{
+    int y;
+    unsigned m, d;
+    civil_from_days(epoch_local_day(epoch), &y, &m, &d);
+    snprintf(out, len, "%02u-%02u-%04d", d, m, y);
+}
+
+void epoch_posix_tz(char *out, size_t len)
+{
+    // POSIX invierte el signo: GMT-6 es "UTC6"
+    int off = -EPOCH_UTC_OFFSET_S;
+    if (off % 3600 == 0) {
+        snprintf(out, len, "UTC%d", off / 3600);
+    } else {
+        snprintf(out, len, "UTC%d:%02d", off / 3600, (off < 0 ? -off : off) / 60 % 60);
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tiempos como epoch UTC entero (segundos). La hora local solo existe para
+// el payload legado ("fecha"/"hora"/"inicio") y para detectar el cambio de
+// día, ambos con aritmética entera sobre un offset fijo: sin localtime_r,
+// strftime ni dependencia de TZ.
+
+// Offset de la hora local respecto de UTC (GMT-6, sin horario de verano)
+#define EPOCH_UTC_OFFSET_S (-6 * 60 * 60)
+
+// Día local desde 1970-01-01 (cambia a medianoche local)
+int32_t epoch_local_day(uint32_t epoch);
+
+// "HH:MM:SS" local (9 bytes con '\0')
+void epoch_format_hms(uint32_t epoch, char *out, size_t len);
+
+// "DD-MM-YYYY" local (11 bytes con '\0')
+void epoch_format_dmy(uint32_t epoch, char *out, size_t len);
+
+// TZ POSIX equivalente al offset ("UTC6"), para los logs que usan localtime
+void epoch_posix_tz(char *out, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
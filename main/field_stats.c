@@ -0,0 +1,41 @@
+#include "field_stats.h"
+
+#include <math.h>
+#include <string.h>
+
+void field_stats_reset(field_stats_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+void field_stats_add(field_stats_t *s, float x)
+{
+    field_stats_add_weighted(s, x, 1.0);
+}
+
+void field_stats_add_weighted(field_stats_t *s, float x, double w)
+{
+    if (w <= 0.0) {
+        return;
+    }
+    s->n++;
+    s->w += w;
+    double delta = (double)x - s->mean;
+    s->mean += delta * (w / s->w);
+    s->m2 += w * delta * ((double)x - s->mean);
+
+    if (s->n == 1 || x < s->min) {
+        s->min = x;
+    }
+    if (s->n == 1 || x > s->max) {
+        s->max = x;
+    }
+}
+
+float field_stats_std(const field_stats_t *s)
+{
+    if (s->n < 2) {
+        return 0.0f;
+    }
+    return (float)sqrt(s->m2 / s->w * (double)s->n / (double)(s->n - 1));
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Acumulador de una pasada (Welford): media, desvío, mínimo y máximo en
+// memoria constante y sin la cancelación numérica de sum/sum². Acepta pesos
+// (West) para promediar por tiempo muestras con intervalos distintos.
+
+typedef struct {
+    uint32_t n;
+    double   w;       // suma de pesos (= n sin pesos)
+    double   mean;
+    double   m2;      // suma de cuadrados de desvíos respecto de la media
+    float    min;
+    float    max;
+} field_stats_t;
+
+void field_stats_reset(field_stats_t *s);
+
+void field_stats_add(field_stats_t *s, float x);
+
+// w > 0: p. ej. el tiempo que representa la muestra
+void field_stats_add_weighted(field_stats_t *s, float x, double w);
+
+// Desvío estándar muestral (n-1, con pesos escalados a n muestras); 0 con
+// menos de dos muestras.
+float field_stats_std(const field_stats_t *s);
+
+#ifdef __cplusplus
+}
+#endif
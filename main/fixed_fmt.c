@@ -0,0 +1,82 @@
+#include "fixed_fmt.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t s_pow10[FIXED_FMT_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+static int fallback(char *buf, size_t len, float v, int decimals)
+{
+    int n = snprintf(buf, len, "%.*f", decimals, (double)v);
+    return (n < 0 || (size_t)n >= len) ? -1 : n;
+}
+
+int fixed_fmt_float(char *buf, size_t len, float v, int decimals)
+{
+    if (decimals < 0 || decimals > FIXED_FMT_MAX_DECIMALS) {
+        return fallback(buf, len, v, decimals);
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    bool neg = bits >> 31;
+    int exp = (int)((bits >> 23) & 0xFF);
+    uint64_t mant = bits & 0x7FFFFF;
+
+    if (exp == 0xFF) {
+        return fallback(buf, len, v, decimals);   // NaN / inf
+    }
+    if (exp == 0) {
+        exp = 1;                                  // subnormal
+    } else {
+        mant |= 1u << 23;
+    }
+    int shift = 150 - exp;                        // v = mant * 2^-shift
+    if (shift < -16) {
+        return fallback(buf, len, v, decimals);   // |v| >= 2^40
+    }
+
+    // q = round(mant * 10^d / 2^shift), al más cercano con empate a par
+    uint64_t scaled = mant * s_pow10[decimals];   // < 2^24 * 10^4 < 2^38
+    uint64_t q;
+    if (shift <= 0) {
+        q = scaled << -shift;
+    } else if (shift >= 63) {
+        q = 0;                                    // < 0.5: scaled < 2^38
+    } else {
+        q = scaled >> shift;
+        uint64_t rem = scaled & ((UINT64_C(1) << shift) - 1);
+        uint64_t half = UINT64_C(1) << (shift - 1);
+        if (rem > half || (rem == half && (q & 1))) {
+            q++;
+        }
+    }
+
+    // Dígitos de atrás hacia adelante
+    char tmp[32];
+    int pos = sizeof(tmp);
+    for (int i = 0; i < decimals; ++i) {
+        tmp[--pos] = (char)('0' + q % 10);
+        q /= 10;
+    }
+    if (decimals > 0) {
+        tmp[--pos] = '.';
+    }
+    do {
+        tmp[--pos] = (char)('0' + q % 10);
+        q /= 10;
+    } while (q);
+    if (neg) {
+        tmp[--pos] = '-';
+    }
+
+    size_t n = sizeof(tmp) - (size_t)pos;
+    if (n >= len) {
+        return -1;
+    }
+    memcpy(buf, tmp + pos, n);
+    buf[n] = '\0';
+    return (int)n;
+}
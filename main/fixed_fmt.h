@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Formateo decimal de floats sin printf, para el JSON de ingest. Sale igual
+// byte a byte que "%.*f" (redondeo al más cercano sobre el valor binario
+// exacto, empate a par, "-0.00" para negativos que redondean a cero).
+// Trabaja con el entero escalado mantisa * 10^decimals en 64 bits, así que
+// no usa double ni la pila de newlib. Fuera de rango (|v| >= 2^40, NaN,
+// inf) o con más de FIXED_FMT_MAX_DECIMALS cae a snprintf.
+
+#define FIXED_FMT_MAX_DECIMALS 4
+
+// Escribe v con decimals decimales y '\0'. Devuelve la longitud o -1 si
+// no entra en len.
+int fixed_fmt_float(char *buf, size_t len, float v, int decimals);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,167 @@
+#include "i2c_sched.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define I2C_SCHED_XFER_TIMEOUT_MS 1000
+
+static const char *TAG = "I2C_SCHED";
+
+// Solo la usa la tarea de sensores; sin lock
+static i2c_sched_stat_t s_stats[I2C_SCHED_MAX_STATS];
+static size_t s_n_stats;
+
+static void stat_record(const i2c_txn_t *t)
+{
+    uint16_t cmd = (uint16_t)((t->cmd[0] << 8) | t->cmd[1]);
+    i2c_sched_stat_t *st = NULL;
+    for (size_t i = 0; i < s_n_stats; ++i) {
+        if (s_stats[i].addr == t->addr && s_stats[i].cmd == cmd) {
+            st = &s_stats[i];
+            break;
+        }
+    }
+    if (!st) {
+        if (s_n_stats >= I2C_SCHED_MAX_STATS) {
+            return;
+        }
+        st = &s_stats[s_n_stats++];
+        st->addr = t->addr;
+        st->cmd = cmd;
+    }
+
+    st->count++;
+    if (t->err != ESP_OK) {
+        st->errors++;
+        return;
+    }
+    st->sum_us += t->latency_us;
+    if (t->latency_us > st->max_us) {
+        st->max_us = t->latency_us;
+    }
+}
+
+// Espera hasta due_us: ticks enteros con vTaskDelay y el resto activo
+// (los tiempos de ejecución de 1 ms son menores que un tick)
+static void wait_until(int64_t due_us)
+{
+    const int64_t tick_us = (int64_t)portTICK_PERIOD_MS * 1000;
+    int64_t left = due_us - esp_timer_get_time();
+    if (left >= tick_us) {
+        vTaskDelay((TickType_t)(left / tick_us));
+        left = due_us - esp_timer_get_time();
+    }
+    if (left > 0) {
+        esp_rom_delay_us((uint32_t)left);
+    }
+}
+
+// Estados de due_us además de un vencimiento (>= 0)
+#define TXN_PENDING (-2)
+#define TXN_DONE    (-1)
+
+static void txn_finish(i2c_txn_t *t)
+{
+    t->latency_us = (uint32_t)(esp_timer_get_time() - t->t0_us);
+    t->due_us = TXN_DONE;
+    stat_record(t);
+}
+
+static void txn_start(i2c_txn_t *t)
+{
+    t->t0_us = esp_timer_get_time();
+    t->err = i2c_master_transmit(t->dev, t->cmd, sizeof(t->cmd),
+                                 pdMS_TO_TICKS(I2C_SCHED_XFER_TIMEOUT_MS));
+    if (t->err != ESP_OK || (t->rx_len == 0 && t->exec_ms == 0)) {
+        txn_finish(t);
+        return;
+    }
+    t->due_us = esp_timer_get_time() + (int64_t)t->exec_ms * 1000;
+}
+
+// Un dispositivo no acepta comandos mientras ejecuta otro: arranca la
+// próxima transacción pendiente de dev solo cuando no tiene ninguna en curso
+static void start_next_for(i2c_txn_t *txns, size_t n, i2c_master_dev_handle_t dev)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (txns[i].dev == dev && txns[i].due_us >= 0) {
+            return;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (txns[i].dev == dev && txns[i].due_us == TXN_PENDING) {
+            txn_start(&txns[i]);
+            if (txns[i].due_us >= 0) {
+                return;
+            }
+        }
+    }
+}
+
+esp_err_t i2c_sched_run(i2c_txn_t *txns, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        txns[i].err = ESP_OK;
+        txns[i].rx_stage = false;
+        txns[i].latency_us = 0;
+        txns[i].due_us = TXN_PENDING;
+    }
+
+    // Fase 1: el primer comando de cada dispositivo arranca su ejecución
+    for (size_t i = 0; i < n; ++i) {
+        start_next_for(txns, n, txns[i].dev);
+    }
+
+    // Fase 2: lecturas por orden de vencimiento; cada una libera al
+    // dispositivo para su siguiente comando
+    for (;;) {
+        i2c_txn_t *next = NULL;
+        for (size_t i = 0; i < n; ++i) {
+            if (txns[i].due_us >= 0 && (!next || txns[i].due_us < next->due_us)) {
+                next = &txns[i];
+            }
+        }
+        if (!next) {
+            break;
+        }
+
+        wait_until(next->due_us);
+        if (next->rx && next->rx_len > 0) {
+            next->err = i2c_master_receive(next->dev, next->rx, next->rx_len,
+                                           pdMS_TO_TICKS(I2C_SCHED_XFER_TIMEOUT_MS));
+            next->rx_stage = true;
+        }
+        txn_finish(next);
+        start_next_for(txns, n, next->dev);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (txns[i].err != ESP_OK) {
+            return txns[i].err;
+        }
+    }
+    return ESP_OK;
+}
+
+size_t i2c_sched_get_stats(i2c_sched_stat_t *out, size_t max)
+{
+    size_t n = s_n_stats < max ? s_n_stats : max;
+    memcpy(out, s_stats, n * sizeof(*out));
+    return n;
+}
+
+void i2c_sched_log_stats(void)
+{
+    for (size_t i = 0; i < s_n_stats; ++i) {
+        const i2c_sched_stat_t *st = &s_stats[i];
+        uint32_t ok = st->count - st->errors;
+        ESP_LOGI(TAG, "0x%02X cmd 0x%04X | n=%u err=%u avg=%u us max=%u us",
+                 st->addr, st->cmd, (unsigned)st->count, (unsigned)st->errors,
+                 (unsigned)(ok ? st->sum_us / ok : 0), (unsigned)st->max_us);
+    }
+}
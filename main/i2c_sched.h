@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/i2c_master.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Planificador de transacciones I2C comando / espera / lectura. Cada
+// dispositivo del lote arranca su primer comando enseguida y las lecturas
+// se hacen en orden de vencimiento, así el tiempo de ejecución de un sensor
+// (1 ms el SCD4x, 20 ms el SEN5x) se solapa con las transferencias del otro
+// en vez de sumarse. Las transacciones de un mismo dispositivo se encadenan
+// en el orden del lote. Corre en la tarea que llama; no crea tareas ni colas.
+
+#define I2C_SCHED_MAX_STATS 8
+
+typedef struct {
+    // Entrada
+    i2c_master_dev_handle_t dev;
+    uint8_t   addr;          // solo para estadísticas y logs
+    uint8_t   cmd[2];
+    uint16_t  exec_ms;       // tiempo de ejecución del comando (datasheet)
+    uint8_t  *rx;            // NULL / rx_len 0 = solo escritura
+    size_t    rx_len;
+
+    // Resultado
+    esp_err_t err;
+    bool      rx_stage;      // err ocurrió en la lectura
+    uint32_t  latency_us;    // inicio del comando -> fin de la lectura
+
+    // Interno
+    int64_t   t0_us;
+    int64_t   due_us;        // vencimiento, o pendiente / terminada
+} i2c_txn_t;
+
+// Latencia por (dirección, comando)
+typedef struct {
+    uint8_t  addr;
+    uint16_t cmd;
+    uint32_t count;
+    uint32_t errors;
+    uint64_t sum_us;
+    uint32_t max_us;
+} i2c_sched_stat_t;
+
+static inline void i2c_txn_init(i2c_txn_t *t, i2c_master_dev_handle_t dev, uint8_t addr,
+                                uint16_t cmd, uint16_t exec_ms, uint8_t *rx, size_t rx_len)
+{
+    *t = (i2c_txn_t){
+        .dev = dev, .addr = addr,
+        .cmd = { (uint8_t)(cmd >> 8), (uint8_t)cmd },
+        .exec_ms = exec_ms, .rx = rx, .rx_len = rx_len,
+    };
+}
+
+// Ejecuta el lote. Devuelve ESP_OK si todas salieron bien, si no el primer
+// error; el resultado de cada una queda en su err.
+esp_err_t i2c_sched_run(i2c_txn_t *txns, size_t n);
+
+// Copia hasta max entradas de estadística. Devuelve cuántas copió.
+size_t i2c_sched_get_stats(i2c_sched_stat_t *out, size_t max);
+
+void i2c_sched_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
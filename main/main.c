@@ -5,6 +5,8 @@
 #include <string.h>
 
 // ESP-IDF
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "nvs_flash.h"
 #include "esp_event.h"
 #include "esp_netif.h"
@@ -17,7 +19,21 @@
 #include "geo_cache.h"
 #include "sensors.h"
 #include "hostinger_ingest.h"
+#include "hostinger_latency.h"
+#include "i2c_sched.h"
 #include "ota_update.h"
+#include "epoch_time.h"
+#include "payload_json.h"
+#include "raw_capture.h"
+#include "robust_agg.h"
+#include "sample_ring.h"
+#include "sample_sched.h"
+#include "sensor_driver.h"
+#include "sensor_fields.h"
+#include "field_stats.h"
+#include "upload_queue.h"
+#include "window.h"
+#include "window_cbor.h"
 
 // PPP / Módem
 #include "modem_ppp.h"
@@ -35,15 +51,75 @@ static char g_firmware_ver[32] = "0.0.0";
 static char g_city[64]  = "----";
 
 #define LOG_EACH_SAMPLE        1
-#define SENSOR_TASK_STACK      10240
+#define SENSOR_TASK_STACK      6144
+#define AGG_TASK_STACK         4096
+#define UPLOAD_TASK_STACK      10240
+
+// Cola RAM de ventanas terminadas entre agg_task y upload_task
+#define WINDOW_QUEUE_LEN       4
+#define WINDOW_QUEUE_DROP_OLDEST    0   // descarta la ventana más vieja
+#define WINDOW_QUEUE_SPILL_TO_FLASH 1   // la pasa a la cola flash (upq)
+#define WINDOW_QUEUE_POLICY    WINDOW_QUEUE_SPILL_TO_FLASH
 
 // Reintentos PPP (similar a WiFi)
 #define PPP_RECONNECT_WINDOW_MS  60000   // Intentar reconectar hasta 60 s
-#define PPP_BACKOFF_IDLE_MS      30000   // Si falla, esperar 30 s y volver a intentar
 #define HOSTINGER_POST_MAX_RETRIES 3
 #define HOSTINGER_POST_RETRY_DELAY_MS 2000
+#define UPQ_DRAIN_MAX_BATCHES 4           // lotes de pendientes a reenviar por ventana
+#define HOSTINGER_BATCH_MAX_BYTES 4096    // tope del body de un lote
+#define HOSTINGER_BATCH_MAX_ROWS  16
+#define HOSTINGER_BATCH_FORMAT    HOSTINGER_BATCH_JSON_ARRAY
+// >0: las ventanas se acumulan en la cola flash y se suben en lote cuando la
+// mas vieja supera esta edad (o se llena un lote). 0 = envio inmediato.
+#define HOSTINGER_BATCH_MAX_AGE_S 0
+// Codificación del envío en vivo (la cola flash y los lotes siguen en JSON)
+#define INGEST_ENCODING_JSON 0
+#define INGEST_ENCODING_CBOR 1   // ver window_cbor.h
+#define INGEST_ENCODING      INGEST_ENCODING_JSON
+// Bodies de al menos estos bytes se envían con gzip (0 = sin compresión; el
+// servidor debe aceptar Content-Encoding: gzip). Rinde sobre todo en lotes.
+#define INGEST_GZIP_MIN_BYTES 0
+// Agregador del valor de ventana por campo (ver robust_agg.h). Todos en
+// media: cambiar uno cambia los datos reportados por toda la flota. Los PM
+// del SEN55 tienen picos aislados de pocas muestras que corren la media de
+// la ventana; WINDOW_AGG_HAMPEL los descarta. Los campos que no usan media
+// se informan en el payload ("agg" / clave CBOR 18).
+static const window_agg_t s_window_agg[SENSOR_FIELD_COUNT] = {
+    [SENSOR_FIELD_PM1P0]  = WINDOW_AGG_MEAN,
+    [SENSOR_FIELD_PM2P5]  = WINDOW_AGG_MEAN,
+    [SENSOR_FIELD_PM4P0]  = WINDOW_AGG_MEAN,
+    [SENSOR_FIELD_PM10P0] = WINDOW_AGG_MEAN,
+};
+// 1 = el JSON de cada ventana lleva "n":{campo:muestras usadas}. Apagado
+// por defecto, igual que "stats": agranda cada fila del envío y de la cola flash
+#define WINDOW_JSON_COUNTS    0
+// 1 = el JSON de cada ventana lleva "stats":{campo:[n,std,min,max]} además
+// de la media (solo JSON; el CBOR no lo incluye)
+#define WINDOW_JSON_STATS     0
+// 1 = el JSON lleva "ts":[inicio,fin] en epoch UTC junto a las horas locales
+#define WINDOW_JSON_EPOCH     1
+// Captura cruda (raw_capture.h): una ventana con PM2.5 >= este umbral
+// arranca una captura de RAW_CAPTURE_EVENT_S con sus propias muestras
+// incluidas (0 = sin disparo local). El servidor también puede pedirla
+// respondiendo {"capture":S} al ingest.
+#define RAW_CAPTURE_PM25_TRIGGER 55.5f
+#define RAW_CAPTURE_EVENT_S      (30 * 60)
+// Presupuesto del disparo local, para que un episodio largo no deje la
+// captura encendida: pausa desde el fin de la captura anterior (de
+// cualquier origen) y tope de capturas locales por día local
+#define RAW_CAPTURE_EVENT_COOLDOWN_S  (2 * 60 * 60)
+#define RAW_CAPTURE_EVENT_MAX_PER_DAY 2
+// Grilla base de muestreo = cadencia del sensor más rápido. Cada sensor se
+// lee cada *_SAMPLE_MS (múltiplo de la base) y la ventana promedia por tiempo.
+// El modo del SCD40 sale de su cadencia (sensors_scd40_mode_for_period): con
+// 5 s periódico; desde 30 s bajo consumo; desde 1 min single-shot.
 #define SAMPLE_DELAY_MS 5000
-#define SAMPLES_PER_SEND_WINDOW 60
+#define SCD_SAMPLE_MS   5000
+#define SEN_SAMPLE_MS   5000
+#define SEND_WINDOW_MS  (5 * 60 * 1000)
+#define SAMPLES_PER_SEND_WINDOW (SEND_WINDOW_MS / SAMPLE_DELAY_MS)
+#define SENSOR_READY_MARGIN_MS  1000
+#define SENSOR_READY_GRACE_MS   (SAMPLE_DELAY_MS / 2)
 #define SNTP_TIME_VALID_EPOCH 1609459200  // 2021-01-01 00:00:00 UTC
 #define SNTP_SYNC_TIMEOUT_MS 60000
 #define SNTP_SYNC_POLL_MS 500
@@ -124,8 +200,10 @@ static bool init_sntp_and_time(void) {
     esp_sntp_set_sync_mode(SNTP_SYNC_MODE_IMMED);
     esp_sntp_init();
 
-    // Zona horaria GMT-6 (ajusta si usas horario de verano distinto)
-    setenv("TZ", "UTC6", 1);
+    // Zona horaria solo para logs; el payload usa EPOCH_UTC_OFFSET_S
+    char tz[16];
+    epoch_posix_tz(tz, sizeof(tz));
+    setenv("TZ", tz, 1);
     tzset();
 
     ESP_LOGI(TAG_APP, "Esperando sincronizacion SNTP hasta %d ms",
@@ -169,48 +247,586 @@ static void build_city_hyphen(char *dst, size_t dstlen, const char *city, const
     }
 }
 
-// ----------------- TASK DE SENSORES + HOSTINGER (PPP) -----------------
-static void sensor_task(void *pv) {
-    // Hora de arranque (inicio) para JSON de primer envío
-    time_t start_epoch;
-    struct tm start_tm_info;
-    char inicio_str[20];
-    time(&start_epoch);
-    localtime_r(&start_epoch, &start_tm_info);
-    strftime(inicio_str, sizeof(inicio_str), "%H:%M:%S", &start_tm_info);
+// ----------------- Cola de envíos pendientes (flash) -----------------
+// ¿Toca subir lo acumulado? Sin modo lote, siempre que haya pendientes.
+static bool upload_batch_due(uint32_t now_epoch) {
+#if HOSTINGER_BATCH_MAX_AGE_S > 0
+    uint32_t oldest_ts = 0;
+    if (upload_queue_count() >= HOSTINGER_BATCH_MAX_ROWS) return true;
+    if (upload_queue_oldest_ts(&oldest_ts) != ESP_OK) return true;
+    return now_epoch - oldest_ts >= HOSTINGER_BATCH_MAX_AGE_S;
+#else
+    (void)now_epoch;
+    return true;
+#endif
+}
 
-    bool first_send = true;
+// Reenvía lo pendiente en lotes, más viejo primero; se detiene al primer fallo.
+static void upload_backlog_drain(int max_batches) {
+    static char batch_buf[HOSTINGER_BATCH_MAX_BYTES];
+    const char *rows[HOSTINGER_BATCH_MAX_ROWS];
+    int sent = 0;
+
+    for (int b = 0; b < max_batches && upload_queue_count() > 0; ++b) {
+        size_t used = 0;
+        int n = 0;
+        while (n < HOSTINGER_BATCH_MAX_ROWS && (uint32_t)n < upload_queue_count()) {
+            size_t len = 0;
+            if (upload_queue_peek_at((uint32_t)n, batch_buf + used, sizeof(batch_buf) - used,
+                                     &len, NULL) != ESP_OK) {
+                break;
+            }
+            rows[n++] = batch_buf + used;
+            used += len + 1;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        int accepted = 0;
+        int rc = hostinger_ingest_post_batch(rows, n, HOSTINGER_BATCH_FORMAT,
+                                             HOSTINGER_BATCH_MAX_BYTES, &accepted);
+        if (rc != 0) {
+            ESP_LOGW(TAG_APP, "Cola flash: lote falló rc=%d, se reintenta después", rc);
+            break;
+        }
+        if (accepted == 0) {
+            // 2xx pero la fila más vieja fue rechazada: se descarta para no trabar la cola
+            ESP_LOGW(TAG_APP, "Cola flash: servidor rechazó la ventana más vieja; se descarta");
+            accepted = 1;
+        }
+        for (int i = 0; i < accepted; ++i) {
+            upload_queue_pop();
+        }
+        sent += accepted;
+    }
+
+    if (sent > 0) {
+        ESP_LOGI(TAG_APP, "Cola flash: %d reenviados, %u pendientes",
+                 sent, (unsigned)upload_queue_count());
+    }
+}
+
+// ----------------- Ventanas terminadas (adquisición -> envío) -----------------
+// Secciones del JSON de cada ventana (payload_json.h)
+#define WINDOW_JSON_BASE   (PAYLOAD_JSON_DBG | PAYLOAD_JSON_AGG | \
+                            (WINDOW_JSON_COUNTS ? PAYLOAD_JSON_COUNTS : 0) | \
+                            (WINDOW_JSON_STATS ? PAYLOAD_JSON_STATS : 0) | \
+                            (WINDOW_JSON_EPOCH ? PAYLOAD_JSON_EPOCH : 0))
+#define WINDOW_JSON_NORMAL WINDOW_JSON_BASE                           // solo hora
+#define WINDOW_JSON_FECHA  (WINDOW_JSON_BASE | PAYLOAD_JSON_FECHA)    // cambio de día / flash
+// Primer envío: ver + fecha/inicio/ciudad + device_id; el reintento va sin "ver"
+#define WINDOW_JSON_FIRST  (WINDOW_JSON_FECHA | PAYLOAD_JSON_VER | PAYLOAD_JSON_INICIO | \
+                            PAYLOAD_JSON_CIUDAD | PAYLOAD_JSON_DEVICE_ID)
+#define WINDOW_JSON_MAX_LEN 896
+
+_Static_assert(SCD_SAMPLE_MS % SAMPLE_DELAY_MS == 0 && SEN_SAMPLE_MS % SAMPLE_DELAY_MS == 0,
+               "las cadencias por sensor deben ser múltiplos de SAMPLE_DELAY_MS");
+_Static_assert(SEND_WINDOW_MS % SCD_SAMPLE_MS == 0 && SEND_WINDOW_MS % SEN_SAMPLE_MS == 0,
+               "la ventana debe contener un número entero de muestras de cada sensor");
+// Los agregadores robustos y la captura re-leen la ventana del ring: toda
+// la ventana tiene que caber. Una base de 1 s (SEN55 a su cadencia nativa)
+// pide 300 muestras: SAMPLE_RING_LEN 512 (potencia de 2), unos 45 KB de RAM
+// interna en este WROVER sin PSRAM, por eso la base queda en 5 s.
+_Static_assert(SAMPLES_PER_SEND_WINDOW <= SAMPLE_RING_LEN,
+               "la ventana no cabe en el ring de muestras (SAMPLE_RING_LEN)");
+// cTe/cHu promedian con la última lectura del SCD40 (sensors_derive)
+_Static_assert(2 * SCD_SAMPLE_MS <= SENSORS_DERIVE_MAX_AGE_MS,
+               "SENSORS_DERIVE_MAX_AGE_MS menor que dos muestras del SCD40");
+
+// Cadencia por sensor (SENSOR_FIELD_SRC_*); los que no figuran van a la base
+typedef struct {
+    uint8_t src;
+    int     period_ms;
+} sensor_rate_t;
+
+static const sensor_rate_t s_sensor_rates[] = {
+    { SENSOR_FIELD_SRC_SCD, SCD_SAMPLE_MS },
+    { SENSOR_FIELD_SRC_SEN, SEN_SAMPLE_MS },
+};
+
+static int sensor_rate_ms(uint8_t src) {
+    for (size_t i = 0; i < sizeof(s_sensor_rates) / sizeof(s_sensor_rates[0]); ++i) {
+        if (s_sensor_rates[i].src == src) return s_sensor_rates[i].period_ms;
+    }
+    return SAMPLE_DELAY_MS;
+}
+
+// Sensores presentes que tocan en el slot
+static uint8_t sensors_due(uint32_t slot) {
+    uint8_t due = 0;
+    for (size_t i = 0; i < sensors_driver_count(); ++i) {
+        uint8_t src = sensors_driver_get(i)->src;
+        uint32_t every = (uint32_t)(sensor_rate_ms(src) / SAMPLE_DELAY_MS);
+        if (slot % every == 0) due |= src;
+    }
+    return due & sensors_present_mask();
+}
+
+// true si ningún sensor vuelve a tocar antes de que termine la ventana del
+// slot: con cadencias más lentas que la base el último slot puede quedar vacío
+static bool window_last_due_slot(uint32_t slot) {
+    uint32_t end = (slot / SAMPLES_PER_SEND_WINDOW + 1) * SAMPLES_PER_SEND_WINDOW;
+    for (uint32_t s = slot + 1; s < end; ++s) {
+        if (sensors_due(s)) return false;
+    }
+    return true;
+}
+
+static QueueHandle_t s_window_q = NULL;
+static uint32_t s_window_dropped = 0;
+static uint32_t s_window_spilled = 0;
+
+static void window_json_build(const window_record_t *w, uint32_t flags,
+                              char *json, size_t json_len) {
+    // Horas locales solo para el payload legado
+    char hora_envio[16];
+    epoch_format_hms(w->end_epoch, hora_envio, sizeof(hora_envio));
+
+    char fecha_actual[20];
+    epoch_format_dmy(w->end_epoch, fecha_actual, sizeof(fecha_actual));
+
+    payload_json_src_t src = {
+        .avg = &w->avg,
+        .stats = w->stats,
+        .agg = w->agg,
+        .present = sensors_present_fields(),
+        .fecha = fecha_actual,
+        .hora = hora_envio,
+        .start_epoch = w->start_epoch,
+        .end_epoch = w->end_epoch,
+    };
+    if (payload_json_write(&src, flags, json, json_len) < 0) {
+        ESP_LOGE(TAG_APP, "JSON de ventana no entra en %u bytes", (unsigned)json_len);
+    }
+}
+
+// Serializa la ventana en json con flags y la encola en flash. La fila
+// siempre lleva fecha+hora porque puede subirse otro día, y nunca "ver"
+// (solo va en el primer envío en vivo).
+static esp_err_t window_push_to_flash(const window_record_t *w, uint32_t flags,
+                                      char *json, size_t json_len) {
+    flags = (flags & ~PAYLOAD_JSON_VER) | PAYLOAD_JSON_FECHA;
+    window_json_build(w, flags, json, json_len);
+    return upload_queue_push(json, strlen(json), w->end_epoch);
+}
+
+// Guarda en la cola flash una ventana que no pasará por upload_task. Solo
+// desde agg_task (window_queue_put): el JSON va en un buffer estático para
+// no sumarlo a su pila, que ya lleva el acumulador y la ventana cerrada.
+static bool window_spill_to_flash(const window_record_t *w) {
+    static char json[WINDOW_JSON_MAX_LEN];
+    return window_push_to_flash(w, WINDOW_JSON_NORMAL, json, sizeof(json)) == ESP_OK;
+}
+
+// Entrega una ventana a upload_task sin bloquear la adquisición. Si la cola
+// RAM está llena se aplica WINDOW_QUEUE_POLICY a la ventana más vieja.
+static void window_queue_put(const window_record_t *w) {
+    if (xQueueSend(s_window_q, w, 0) == pdTRUE) {
+        return;
+    }
+
+    static window_record_t oldest;     // solo agg_task, como el buffer del derrame
+    if (xQueueReceive(s_window_q, &oldest, 0) == pdTRUE) {
+#if WINDOW_QUEUE_POLICY == WINDOW_QUEUE_SPILL_TO_FLASH
+        if (window_spill_to_flash(&oldest)) {
+            s_window_spilled++;
+            // Pila mínima libre de agg_task tras el camino más hondo (flash)
+            ESP_LOGW(TAG_APP, "Envío atrasado: ventana más vieja derramada a flash "
+                     "(total=%u, pila libre mín=%u B)",
+                     (unsigned)s_window_spilled,
+                     (unsigned)uxTaskGetStackHighWaterMark(NULL));
+        } else
+#endif
+        {
+            s_window_dropped++;
+            ESP_LOGW(TAG_APP, "Envío atrasado: ventana más vieja descartada (total=%u)",
+                     (unsigned)s_window_dropped);
+        }
+    }
+
+    if (xQueueSend(s_window_q, w, 0) != pdTRUE) {
+        s_window_dropped++;
+        ESP_LOGE(TAG_APP, "No se pudo encolar la ventana nueva");
+    }
+}
+
+// ----------------- TASK DE AGREGACIÓN (ventanas) -----------------
+// Acumuladores de la ventana en curso (uno por campo de medición)
+typedef struct {
+    int samples;            // muestras recibidas en la ventana
+    uint32_t window;        // índice de ventana (slot / SAMPLES_PER_SEND_WINDOW)
+    uint32_t start_epoch;   // epoch de la primera muestra
+    uint32_t first_idx;     // índice en el ring de la primera muestra
+    uint32_t end_idx;       // índice siguiente a la última
+    field_stats_t field[SENSOR_FIELD_COUNT];
+    uint32_t jitter_abs_sum_ms;
+    uint32_t jitter_max_ms;
+} window_acc_t;
+
+// Buffers de los agregadores robustos: estáticos para no cargar la pila de
+// agg_task (solo la usa esa tarea)
+static float s_agg_vals[SAMPLE_RING_LEN];
+static float s_agg_scratch[SAMPLE_RING_LEN];
+
+// Última muestra válida de cada sensor (por bit de src), entre ventanas
+static int64_t s_src_last_us[8];
+
+static int src_index(uint8_t src) {
+    return __builtin_ctz(src);
+}
+
+// Peso (ms) de la muestra de un sensor: el intervalo desde su muestra
+// anterior, que es lo que promedia su salida. Acotado a dos períodos para
+// que un hueco largo no domine; sin anterior, un período nominal.
+static double sample_weight_ms(uint8_t src, int64_t t_us) {
+    int period_ms = sensor_rate_ms(src);
+    int64_t *last = &s_src_last_us[src_index(src)];
+    double dt_ms = *last ? (double)(t_us - *last) / 1000.0 : (double)period_ms;
+    *last = t_us;
+    if (dt_ms <= 0.0) return period_ms;
+    if (dt_ms > 2.0 * period_ms) return 2.0 * period_ms;
+    return dt_ms;
+}
+
+static void window_acc_add(window_acc_t *acc, const sample_t *smp, uint32_t ring_idx) {
+    if (acc->samples == 0) {
+        acc->first_idx = ring_idx;
+        acc->start_epoch = (uint32_t)smp->epoch;
+    }
+    acc->end_idx = ring_idx + 1;
+    acc->window = smp->slot / SAMPLES_PER_SEND_WINDOW;
+    acc->samples++;
+
+    uint32_t jitter = (uint32_t)(smp->jitter_ms < 0 ? -smp->jitter_ms : smp->jitter_ms);
+    acc->jitter_abs_sum_ms += jitter;
+    if (jitter > acc->jitter_max_ms) acc->jitter_max_ms = jitter;
+
+    double weight[8] = {0};
+    for (size_t i = 0; i < sensors_driver_count(); ++i) {
+        uint8_t src = sensors_driver_get(i)->src;
+        if (smp->flags & src) {
+            weight[src_index(src)] = sample_weight_ms(src, smp->t_us);
+        }
+    }
+
+    uint32_t present = sensors_present_fields();
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        if (!(present & (1u << f))) continue;
+        uint8_t src = g_sensor_fields[f].src;
+        if (smp->flags & src) {
+            field_stats_add_weighted(&acc->field[f], sensor_field_get(&smp->data, (sensor_field_t)f),
+                                     weight[src_index(src)]);
+        }
+    }
+}
 
+// Re-lee del ring los valores válidos del campo f en la ventana. Devuelve
+// cuántos copió (menos que los acumulados si el ring ya los sobrescribió).
+static size_t window_collect_field(const window_acc_t *acc, sensor_field_t f, float *out) {
+    size_t n = 0;
+    sample_t smp;
+    for (uint32_t idx = acc->first_idx; idx != acc->end_idx && n < SAMPLE_RING_LEN; ++idx) {
+        if (sample_ring_get(idx, &smp) && (smp.flags & g_sensor_fields[f].src)) {
+            out[n++] = sensor_field_get(&smp.data, f);
+        }
+    }
+    return n;
+}
+
+// Valor de la ventana para un campo con agregador robusto. Si no están todas
+// las muestras en el ring se queda con la media y devuelve WINDOW_AGG_MEAN.
+// *used = muestras que entran en el valor (sin las descartadas).
+static window_agg_t window_robust_value(const window_acc_t *acc, sensor_field_t f,
+                                        window_agg_t agg, float *value, uint16_t *used) {
+    size_t n = window_collect_field(acc, f, s_agg_vals);
+    if (n == 0 || n != acc->field[f].n) {
+        ESP_LOGW(TAG_APP, "%s: %u/%u muestras en el ring, se usa la media",
+                 g_sensor_fields[f].key, (unsigned)n, (unsigned)acc->field[f].n);
+        return WINDOW_AGG_MEAN;
+    }
+
+    size_t rejected = 0;
+    switch (agg) {
+    case WINDOW_AGG_MEDIAN:
+        *value = robust_median(s_agg_vals, n);
+        break;
+    case WINDOW_AGG_TRIMMED: {
+        size_t g = (size_t)((float)n * ROBUST_TRIM_FRACTION);
+        *value = robust_trimmed_mean(s_agg_vals, n, ROBUST_TRIM_FRACTION);
+        rejected = (2 * g < n) ? 2 * g : 0;   // si no, es la mediana
+        break;
+    }
+    case WINDOW_AGG_HAMPEL:
+        *value = robust_hampel_mean(s_agg_vals, s_agg_scratch, n, ROBUST_HAMPEL_K,
+                                    g_sensor_fields[f].resolution, &rejected);
+        break;
+    default:
+        return WINDOW_AGG_MEAN;
+    }
+    *used = (uint16_t)(n - rejected);
+    if (agg == WINDOW_AGG_HAMPEL && rejected > 0) {
+        ESP_LOGI(TAG_APP, "%s: %u picos descartados (media=%.2f %s=%.2f)",
+                 g_sensor_fields[f].key, (unsigned)rejected,
+                 acc->field[f].mean, robust_agg_name(agg), *value);
+    }
+    return agg;
+}
+
+// Disparo local de captura: sin otra en curso, pasada la pausa desde la
+// anterior y dentro del tope diario. Cuenta el disparo si lo permite.
+static bool raw_capture_event_allowed(void) {
+    static int32_t s_day = INT32_MIN;
+    static uint8_t s_today;
+
+    if (raw_capture_active()) return false;
+
+    uint32_t now = (uint32_t)time(NULL);
+    int32_t day = epoch_local_day(now);
+    if (day != s_day) {
+        s_day = day;
+        s_today = 0;
+    }
+    if (s_today >= RAW_CAPTURE_EVENT_MAX_PER_DAY) return false;
+
+    raw_capture_stats_t st;
+    raw_capture_get_stats(&st);
+    if (st.capture_id != 0 && now < st.end_epoch + RAW_CAPTURE_EVENT_COOLDOWN_S) return false;
+
+    if (++s_today == RAW_CAPTURE_EVENT_MAX_PER_DAY) {
+        ESP_LOGI(TAG_APP, "Captura por evento: tope diario (%d) alcanzado",
+                 RAW_CAPTURE_EVENT_MAX_PER_DAY);
+    }
+    return true;
+}
+
+// Cierra la ventana (promedia, entrega a upload_task) y reinicia acumuladores
+static void window_acc_close(window_acc_t *acc) {
+    window_record_t w = {0};
+    SensorData *window_avg = &w.avg;
+
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        const field_stats_t *fs = &acc->field[f];
+        window_field_summary_t *sum = &w.stats[f];
+        sum->n = (uint16_t)fs->n;
+        sum->used = sum->n;
+        if (fs->n == 0) continue;
+        float value = (float)fs->mean;
+        if (s_window_agg[f] != WINDOW_AGG_MEAN) {
+            w.agg[f] = (uint8_t)window_robust_value(acc, (sensor_field_t)f, s_window_agg[f],
+                                                    &value, &sum->used);
+        }
+        sensor_field_set(window_avg, (sensor_field_t)f, value);
+        sum->std = field_stats_std(fs);
+        sum->min = fs->min;
+        sum->max = fs->max;
+    }
+    window_avg->scd_temp = window_avg->avg_temp;
+    window_avg->scd_hum  = window_avg->avg_hum;
+
+    if (RAW_CAPTURE_PM25_TRIGGER > 0 && w.stats[SENSOR_FIELD_PM2P5].n > 0 &&
+        window_avg->pm2p5 >= RAW_CAPTURE_PM25_TRIGGER && raw_capture_event_allowed()) {
+        raw_capture_start(RAW_CAPTURE_EVENT_S, "PM2.5 alto");
+        // La ventana que disparó también va, si el ring aún la tiene
+        sample_t smp;
+        uint32_t n = 0;
+        for (uint32_t idx = acc->first_idx; idx != acc->end_idx && n < SAMPLE_RING_LEN; ++idx, ++n) {
+            if (sample_ring_get(idx, &smp)) raw_capture_add(&smp);
+        }
+    }
+
+    // Slots de la ventana en que tocaba leer algún sensor y no llegó muestra
+    int expected = 0;
+    for (uint32_t i = 0; i < SAMPLES_PER_SEND_WINDOW; ++i) {
+        if (sensors_due(acc->window * SAMPLES_PER_SEND_WINDOW + i)) expected++;
+    }
+    int missed = expected - acc->samples;
+    uint32_t jitter_avg = acc->samples ? acc->jitter_abs_sum_ms / acc->samples : 0;
+
+    w.scd_samples = w.stats[SENSOR_FIELD_CO2].n;
+    w.sen_samples = w.stats[SENSOR_FIELD_PM2P5].n;
+    w.missed_slots = (uint16_t)(missed > 0 ? missed : 0);
+    w.jitter_avg_ms = (uint16_t)(jitter_avg > UINT16_MAX ? UINT16_MAX : jitter_avg);
+    w.jitter_max_ms = (uint16_t)(acc->jitter_max_ms > UINT16_MAX ? UINT16_MAX : acc->jitter_max_ms);
+    w.start_epoch = acc->start_epoch;
+    w.end_epoch = (uint32_t)time(NULL);
+
+    ESP_LOGI(TAG_APP,
+             "Resumen 5m | co2=%u sen55_temp_dbg=%.2f sen55_hum_dbg=%.2f | "
+             "muestras=%d perdidas=%u jitter avg=%u max=%u ms",
+             window_avg->co2,
+             window_avg->sen_temp,
+             window_avg->sen_hum,
+             acc->samples,
+             (unsigned)w.missed_slots,
+             (unsigned)w.jitter_avg_ms,
+             (unsigned)w.jitter_max_ms);
+
+    window_queue_put(&w);
+    memset(acc, 0, sizeof(*acc));
+}
+
+// Consume el ring de muestras y arma ventanas de SAMPLES_PER_SEND_WINDOW slots
+static void agg_task(void *pv) {
+    sample_ring_reader_t rd;
+    sample_ring_reader_init(&rd, true);
+    sample_ring_subscribe(xTaskGetCurrentTaskHandle());
+
+    window_acc_t acc = {0};
+    uint32_t cur_window = 0;
+    uint32_t overruns_logged = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        sample_t smp;
+        while (sample_ring_read(&rd, &smp)) {
+            // Un atraso largo puede saltar el cierre: la ventana dura lo mismo
+            uint32_t win = smp.slot / SAMPLES_PER_SEND_WINDOW;
+            if (acc.samples > 0 && win != cur_window) {
+                window_acc_close(&acc);
+            }
+            cur_window = win;
+
+            window_acc_add(&acc, &smp, rd.next - 1);
+            raw_capture_add(&smp);
+
+            if (window_last_due_slot(smp.slot)) {
+                window_acc_close(&acc);
+            }
+        }
+
+        if (rd.overruns != overruns_logged) {
+            ESP_LOGW(TAG_APP, "Ring de muestras: %u muestras sobrescritas sin agregar",
+                     (unsigned)(rd.overruns - overruns_logged));
+            overruns_logged = rd.overruns;
+        }
+    }
+}
+
+// ----------------- TASK DE SENSORES (solo adquisición) -----------------
+#if LOG_EACH_SAMPLE
+// "SCD4x diag=00 ok | SEN5x diag=00 ok" de los sensores presentes
+static void sensor_diag_format(uint8_t ok, char *buf, size_t len) {
+    size_t pos = 0;
+    buf[0] = '\0';
+    for (size_t i = 0; i < sensors_driver_count() && pos < len; ++i) {
+        const sensor_driver_t *drv = sensors_driver_get(i);
+        if (!(sensors_present_mask() & drv->src)) continue;
+        int n = snprintf(buf + pos, len - pos, "%s%s diag=%02d %s",
+                         pos ? " | " : "", drv->name, drv->diag(),
+                         (ok & drv->src) ? "ok" : "FALLO");
+        if (n < 0) break;
+        pos += (size_t)n;
+    }
+}
+#endif
+
+static void sensor_task(void *pv) {
     vTaskDelay(pdMS_TO_TICKS(1000));
 
-    // Ya no se realiza borrado al arranque.
+    // Con sensores periódicos la grilla arranca justo después de una
+    // medición nueva, así cada deadline cae pegado a su cadencia nativa.
+    // A demanda (single-shot) la medición la dispara cada slot.
+    bool on_demand = sensors_on_demand();
+    if (!on_demand && sensors_align(SENSOR_READY_MARGIN_MS) != ESP_OK) {
+        ESP_LOGW(TAG_APP, "Sin data-ready al alinear; grilla desde ahora");
+    }
 
-    const TickType_t SAMPLE_DELAY_TICKS = pdMS_TO_TICKS(SAMPLE_DELAY_MS);
+    sample_sched_t sched;
+    sample_sched_init(&sched, SAMPLE_DELAY_MS);
 
-    int sample_slot = 0;
-    uint32_t sum_co2 = 0;
-    int scd40_ok_count_5m = 0;
+    while (1) {
+        uint32_t slot = sample_sched_wait(&sched);
+        sample_t smp = { .slot = slot };
+
+        // Solo los sensores cuya cadencia cae en este slot
+        uint8_t due = sensors_due(slot);
+        if (!due) continue;
+
+        if (on_demand) {
+            // La muestra corresponde al disparo, no al fin de la medición
+            smp.t_us = esp_timer_get_time();
+            smp.jitter_ms = (int16_t)sample_sched_jitter_ms(&sched, slot);
+            sensors_trigger(due);
+        }
+        uint8_t ready = sensors_wait_ready(due, SENSOR_READY_GRACE_MS, SENSOR_READY_MARGIN_MS);
+        if (!on_demand) {
+            smp.t_us = esp_timer_get_time();
+            smp.jitter_ms = (int16_t)sample_sched_jitter_ms(&sched, slot);
+        }
+        time(&smp.epoch);
 
-    int sen55_valid_count_5m = 0;
+        // Un solo lote intercalado para todos los sensores listos
+        int64_t acq_t0 = esp_timer_get_time();
+        smp.flags = sensors_read_mask(&smp.data, ready & due);
+        int acq_ms = (int)((esp_timer_get_time() - acq_t0) / 1000);
+        sample_ring_push(&smp);
 
-    double sum_pm1p0    = 0;
-    double sum_pm2p5    = 0;
-    double sum_pm4p0    = 0;
-    double sum_pm10p0   = 0;
-    double sum_voc      = 0;
-    double sum_nox      = 0;
-    double sum_sen_temp = 0;
-    double sum_sen_hum  = 0;
-    double sum_avg_temp = 0;
-    double sum_avg_hum  = 0;
+    #if LOG_EACH_SAMPLE
+        char diag[96];
+        sensor_diag_format(smp.flags, diag, sizeof(diag));
+        ESP_LOGI(TAG_APP,
+            "Muestra %d/%d de 5m | jitter=%d ms i2c=%d ms | %s",
+            (int)(slot % SAMPLES_PER_SEND_WINDOW) + 1,
+            SAMPLES_PER_SEND_WINDOW,
+            smp.jitter_ms,
+            acq_ms,
+            diag);
+    #else
+        (void)acq_ms;
+    #endif
+    }
+}
+
+// ----------------- TASK DE ENVÍO A HOSTINGER (PPP) -----------------
+// Sube los bloques de captura cruda terminados. Un fallo de transporte o 5xx
+// deja el bloque para el próximo ciclo (mientras tanto la captura descarta
+// si se llenan ambos); un 4xx es permanente (p.ej. 415 si el endpoint no
+// acepta el formato) y el bloque se descarta para no trabar la captura.
+static void raw_capture_upload(void) {
+    static uint8_t body[RAW_CAPTURE_BLOCK_LEN + 96];
+    size_t len;
+    uint32_t capture_id;
+    uint16_t seq;
+    const uint8_t *block;
+    while ((block = raw_capture_peek(&len, &capture_id, &seq)) != NULL) {
+        size_t n = window_cbor_encode_capture(DEVICE_ID, capture_id, seq, block, len,
+                                              body, sizeof(body));
+        int rc = n ? hostinger_ingest_post_raw(body, n, WINDOW_CBOR_CAPTURE_CONTENT_TYPE) : -1;
+        // rc = -100 - status HTTP (hostinger_http_post)
+        bool rejected = rc <= -100 - 400 && rc > -100 - 500;
+        // Un bloque que no entra en el sobre no va a entrar nunca
+        raw_capture_release(rc == 0 || n == 0 || rejected);
+        if (rejected || n == 0) {
+            ESP_LOGE(TAG_APP, "Captura %u bloque %u rechazado (rc=%d); se descarta",
+                     (unsigned)capture_id, (unsigned)seq, rc);
+        } else if (rc != 0) {
+            ESP_LOGW(TAG_APP, "Captura %u bloque %u no enviado (rc=%d); se reintenta",
+                     (unsigned)capture_id, (unsigned)seq, rc);
+            break;
+        }
+    }
+}
+
+static void upload_task(void *pv) {
+    // Hora de arranque (inicio) para JSON de primer envío
+    uint32_t start_epoch = (uint32_t)time(NULL);
+    char inicio_str[16];
+    epoch_format_hms(start_epoch, inicio_str, sizeof(inicio_str));
+    payload_json_set_inicio(inicio_str);
 
-    char last_fecha_str[20] = "";
+    bool first_send = true;
+
+    // Ya no se realiza borrado al arranque.
+
+    int32_t last_day = INT32_MIN;     // día local del último envío
     geo_cache_state_t geo_state = {0};
     int64_t next_geo_retry_ms = 0;
 
     esp_err_t geo_cache_err = geo_cache_load(&geo_state);
     if (geo_cache_err != ESP_OK) {
-        ESP_LOGW(TAG_APP, "No se pudo cargar estado geo en sensor_task: %s",
+        ESP_LOGW(TAG_APP, "No se pudo cargar estado geo en upload_task: %s",
                  esp_err_to_name(geo_cache_err));
     }
     ESP_LOGI(TAG_APP,
@@ -221,332 +837,255 @@ static void sensor_task(void *pv) {
              geo_state.last_city[0] ? geo_state.last_city : "");
 
     while (1) {
+        window_record_t w;
+        if (xQueueReceive(s_window_q, &w, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
 
-        // === Guard de PPP para sensado/envío ===
+        // Un solo buffer: el reintento del primer envío se re-serializa sin "ver"
+        char json[WINDOW_JSON_MAX_LEN];
+
+        // === Guard de PPP para envío (la medición sigue en sensor_task) ===
         if (!modem_ppp_is_connected()) {
-            ESP_LOGW(TAG_APP, "PPP caído -> pauso medición/envío y reconecto");
+            ESP_LOGW(TAG_APP, "PPP caído -> reconecto (la medición continúa)");
+            hostinger_ingest_close();   // el socket keep-alive ya no sirve
             bool ok = modem_ppp_reconnect_blocking(PPP_RECONNECT_WINDOW_MS);
             if (!ok) {
+                bool spilled = window_push_to_flash(&w, WINDOW_JSON_NORMAL, json,
+                                                    sizeof(json)) == ESP_OK;
                 ESP_LOGW(TAG_APP,
-                        "No se logró reconectar PPP, espero %d ms",
-                        PPP_BACKOFF_IDLE_MS);
-                vTaskDelay(pdMS_TO_TICKS(PPP_BACKOFF_IDLE_MS));
+                        "No se logró reconectar PPP; ventana %s",
+                        spilled ? "guardada en cola flash" : "perdida (cola flash no disponible)");
                 continue;
             }
             modem_ppp_force_public_dns();
             ESP_LOGI(TAG_APP, "DNS publicos reaplicados tras reconectar PPP");
-            ESP_LOGI(TAG_APP, "PPP reconectado; reanudo medición/envío");
+            ESP_LOGI(TAG_APP, "PPP reconectado; reanudo envío");
+            if (upload_batch_due((uint32_t)time(NULL))) {
+                upload_backlog_drain(UPQ_DRAIN_MAX_BATCHES);
+            }
         }
 
-        SensorData data = {0};
+        int32_t day = epoch_local_day(w.end_epoch);
+        bool include_fecha = first_send || day != last_day;
+        bool day_changed = (!first_send && include_fecha);
 
-        // ----------------- SCD40 -----------------
-        esp_err_t scd_ret = sensors_read_scd40(&data);
-        int scd_diag = sensors_get_last_scd40_diag();
-
-        if (scd_ret == ESP_OK) {
-            sum_co2 += data.co2;
-            scd40_ok_count_5m++;
-        }
-
-        // ----------------- SEN55 -----------------
-        esp_err_t sen_ret = sensors_read_sen55(&data);
-        int sen_diag = sensors_get_last_sen55_diag();
-
-        if (sen_ret == ESP_OK) {
-            sum_pm1p0    += data.pm1p0;
-            sum_pm2p5    += data.pm2p5;
-            sum_pm4p0    += data.pm4p0;
-            sum_pm10p0   += data.pm10p0;
-            sum_voc      += data.voc;
-            sum_nox      += data.nox;
-            sum_sen_temp += data.sen_temp;
-            sum_sen_hum  += data.sen_hum;
-            sum_avg_temp += data.avg_temp;
-            sum_avg_hum  += data.avg_hum;
-            sen55_valid_count_5m++;
-        }
+        uint32_t json_flags = first_send    ? WINDOW_JSON_FIRST
+                            : include_fecha ? WINDOW_JSON_FECHA
+                                            : WINDOW_JSON_NORMAL;
+        window_json_build(&w, json_flags, json, sizeof(json));
 
     #if LOG_EACH_SAMPLE
-        ESP_LOGI(TAG_APP,
-            "Muestra %d/%d de 5m | SCD40: co2_raw=%u diag=%02d ret=%s | SEN55: diag=%02d ret=%s",
-            sample_slot + 1,
-            SAMPLES_PER_SEND_WINDOW,
-            data.co2,
-            scd_diag,
-            esp_err_to_name(scd_ret),
-            sen_diag,
-            esp_err_to_name(sen_ret));
+        ESP_LOGI(TAG_APP, "JSON promedio/debug: %s", json);
     #endif
 
-        sample_slot++;
-
-        if (sample_slot >= SAMPLES_PER_SEND_WINDOW) {
-            SensorData window_avg = (SensorData){0};
-
-            if (scd40_ok_count_5m > 0) {
-                window_avg.co2 = (uint16_t)(sum_co2 / scd40_ok_count_5m);
+        // --- Envío a Hostinger con hasta 3 intentos ---
+        // Con pendientes en flash (o en modo lote), la ventana se encola detrás
+        // para conservar el orden.
+        int rc = -1;
+        bool backlog = upload_queue_count() > 0 ||
+                       (HOSTINGER_BATCH_MAX_AGE_S > 0 && upload_queue_is_ready());
+        for (int attempt = 1; !backlog && attempt <= HOSTINGER_POST_MAX_RETRIES; ++attempt) {
+#if INGEST_ENCODING == INGEST_ENCODING_CBOR
+            window_cbor_extra_t extra = {0};
+            if (first_send) {
+                extra.ver = (attempt == 1) ? g_firmware_ver : NULL;
+                extra.ciudad = g_city;
+                extra.inicio_epoch = start_epoch;
             }
-
-            if (sen55_valid_count_5m > 0) {
-                double denom = (double)sen55_valid_count_5m;
-                window_avg.pm1p0    = (float)(sum_pm1p0    / denom);
-                window_avg.pm2p5    = (float)(sum_pm2p5    / denom);
-                window_avg.pm4p0    = (float)(sum_pm4p0    / denom);
-                window_avg.pm10p0   = (float)(sum_pm10p0   / denom);
-                window_avg.voc      = (float)(sum_voc      / denom);
-                window_avg.nox      = (float)(sum_nox      / denom);
-                window_avg.sen_temp = (float)(sum_sen_temp / denom);
-                window_avg.sen_hum  = (float)(sum_sen_hum  / denom);
-                window_avg.avg_temp = (float)(sum_avg_temp / denom);
-                window_avg.avg_hum  = (float)(sum_avg_hum  / denom);
-                window_avg.scd_temp = window_avg.avg_temp;
-                window_avg.scd_hum  = window_avg.avg_hum;
+            uint8_t cbor[WINDOW_CBOR_MAX_LEN];
+            size_t cbor_len = window_cbor_encode(&w, DEVICE_ID, &extra, cbor, sizeof(cbor));
+            rc = cbor_len ? hostinger_ingest_post_raw(cbor, cbor_len, WINDOW_CBOR_CONTENT_TYPE)
+                          : -1;
+#else
+            if (attempt == 2 && (json_flags & PAYLOAD_JSON_VER)) {
+                json_flags &= ~PAYLOAD_JSON_VER;
+                window_json_build(&w, json_flags, json, sizeof(json));
+            }
+            rc = hostinger_ingest_post(json);
+#endif
+            if (rc == 0) {
+                if (attempt > 1) {
+                    ESP_LOGW(TAG_APP,
+                            "Envío a Hostinger exitoso en intento %d/%d",
+                            attempt, HOSTINGER_POST_MAX_RETRIES);
+                }
+                break;
             }
 
-            ESP_LOGI(TAG_APP,
-                     "Resumen 5m | co2=%u sen55_temp_dbg=%.2f sen55_hum_dbg=%.2f",
-                     window_avg.co2,
-                     window_avg.sen_temp,
-                     window_avg.sen_hum);
-
-            time_t now_epoch;
-            struct tm tm_info;
-            time(&now_epoch);
-            localtime_r(&now_epoch, &tm_info);
-
-            char hora_envio[16];
-            strftime(hora_envio, sizeof(hora_envio), "%H:%M:%S", &tm_info);
+            ESP_LOGE(TAG_APP,
+                    "Falló envío a Hostinger rc=%d (intento %d/%d)",
+                    rc, attempt, HOSTINGER_POST_MAX_RETRIES);
 
-            char fecha_actual[20];
-            strftime(fecha_actual, sizeof(fecha_actual), "%d-%m-%Y", &tm_info);
+            if (attempt < HOSTINGER_POST_MAX_RETRIES) {
+                vTaskDelay(pdMS_TO_TICKS(HOSTINGER_POST_RETRY_DELAY_MS));
+            }
+        }
 
-            char json[896];
-            char json_retry_no_ver[896];
-            bool has_retry_no_ver = false;
+        if (backlog || rc != 0) {
+            esp_err_t qerr = window_push_to_flash(&w, json_flags, json, sizeof(json));
+            if (qerr != ESP_OK) {
+                ESP_LOGE(TAG_APP,
+                        "Envío fallido y no se pudo encolar en flash (%s). Reiniciando ESP32...",
+                        esp_err_to_name(qerr));
+                vTaskDelay(pdMS_TO_TICKS(HOSTINGER_POST_RETRY_DELAY_MS));
+                esp_restart();
+            }
+            if (!backlog) {
+                ESP_LOGW(TAG_APP,
+                        "Fallaron %d intentos a Hostinger; ventana guardada en cola flash (%u pendientes)",
+                        HOSTINGER_POST_MAX_RETRIES, (unsigned)upload_queue_count());
+            }
+        }
 
-            bool include_fecha = first_send ||
-                                (strncmp(last_fecha_str, fecha_actual,
-                                         sizeof(last_fecha_str)) != 0);
-            bool day_changed = (!first_send && include_fecha);
+        if ((backlog || rc == 0) && upload_batch_due((uint32_t)time(NULL))) {
+            upload_backlog_drain(UPQ_DRAIN_MAX_BATCHES);
+        }
 
-            if (first_send) {
-                snprintf(json, sizeof(json),
-                    "{\"pm1p0\":%.2f,\"pm2p5\":%.2f,\"pm4p0\":%.2f,\"pm10p0\":%.2f,"
-                    "\"voc\":%.1f,\"nox\":%.1f,\"cTe\":%.2f,\"cHu\":%.2f,\"co2\":%u,"
-                    "\"sen55_temp_dbg\":%.2f,\"sen55_hum_dbg\":%.2f,"
-                    "\"ver\":\"%s\","
-                    "\"fecha\":\"%s\",\"inicio\":\"%s\",\"ciudad\":\"%s\",\"hora\":\"%s\","
-                    "\"device_id\":\"%s\"}",
-                    window_avg.pm1p0, window_avg.pm2p5, window_avg.pm4p0, window_avg.pm10p0,
-                    window_avg.voc, window_avg.nox, window_avg.avg_temp, window_avg.avg_hum, window_avg.co2,
-                    window_avg.sen_temp, window_avg.sen_hum,
-                    g_firmware_ver, fecha_actual, inicio_str, g_city, hora_envio, DEVICE_ID);
-
-                snprintf(json_retry_no_ver, sizeof(json_retry_no_ver),
-                    "{\"pm1p0\":%.2f,\"pm2p5\":%.2f,\"pm4p0\":%.2f,\"pm10p0\":%.2f,"
-                    "\"voc\":%.1f,\"nox\":%.1f,\"cTe\":%.2f,\"cHu\":%.2f,\"co2\":%u,"
-                    "\"sen55_temp_dbg\":%.2f,\"sen55_hum_dbg\":%.2f,"
-                    "\"fecha\":\"%s\",\"inicio\":\"%s\",\"ciudad\":\"%s\",\"hora\":\"%s\","
-                    "\"device_id\":\"%s\"}",
-                    window_avg.pm1p0, window_avg.pm2p5, window_avg.pm4p0, window_avg.pm10p0,
-                    window_avg.voc, window_avg.nox, window_avg.avg_temp, window_avg.avg_hum, window_avg.co2,
-                    window_avg.sen_temp, window_avg.sen_hum,
-                    fecha_actual, inicio_str, g_city, hora_envio, DEVICE_ID);
-                has_retry_no_ver = true;
-
-            } else if (include_fecha) {
-                snprintf(json, sizeof(json),
-                    "{\"pm1p0\":%.2f,\"pm2p5\":%.2f,\"pm4p0\":%.2f,\"pm10p0\":%.2f,"
-                    "\"voc\":%.1f,\"nox\":%.1f,\"cTe\":%.2f,\"cHu\":%.2f,\"co2\":%u,"
-                    "\"sen55_temp_dbg\":%.2f,\"sen55_hum_dbg\":%.2f,"
-                    "\"fecha\":\"%s\",\"hora\":\"%s\"}",
-                    window_avg.pm1p0, window_avg.pm2p5, window_avg.pm4p0, window_avg.pm10p0,
-                    window_avg.voc, window_avg.nox, window_avg.avg_temp, window_avg.avg_hum, window_avg.co2,
-                    window_avg.sen_temp, window_avg.sen_hum,
-                    fecha_actual, hora_envio);
+        uint32_t capture_s = hostinger_ingest_take_capture_request();
+        if (capture_s > 0) {
+            raw_capture_start(capture_s, "servidor");
+        }
+        if (backlog || rc == 0) {
+            raw_capture_upload();
+        }
 
+        if (day_changed) {
+            char fecha_actual[12];
+            epoch_format_dmy(w.end_epoch, fecha_actual, sizeof(fecha_actual));
+
+            // Resumen diario de latencias HTTP (DNS/conexión/envío/TTFB/body)
+            hostinger_lat_log();
+            // Y de las transacciones I2C por sensor/comando
+            i2c_sched_log_stats();
+            // Salud de sensores (fallos y recuperaciones) junto con las latencias
+            sensors_health_log();
+            static char sensors_extra[360];
+            memcpy(sensors_extra, "\"sensors\":", 10);
+            if (sensors_health_format_json(sensors_extra + 10, sizeof(sensors_extra) - 10) > 0) {
+                (void)hostinger_post_telemetry(NULL, sensors_extra);
             } else {
-                snprintf(json, sizeof(json),
-                    "{\"pm1p0\":%.2f,\"pm2p5\":%.2f,\"pm4p0\":%.2f,\"pm10p0\":%.2f,"
-                    "\"voc\":%.1f,\"nox\":%.1f,\"cTe\":%.2f,\"cHu\":%.2f,\"co2\":%u,"
-                    "\"sen55_temp_dbg\":%.2f,\"sen55_hum_dbg\":%.2f,"
-                    "\"hora\":\"%s\"}",
-                    window_avg.pm1p0, window_avg.pm2p5, window_avg.pm4p0, window_avg.pm10p0,
-                    window_avg.voc, window_avg.nox, window_avg.avg_temp, window_avg.avg_hum, window_avg.co2,
-                    window_avg.sen_temp, window_avg.sen_hum,
-                    hora_envio);
+                (void)hostinger_post_latency_telemetry(NULL);
             }
 
-    #if LOG_EACH_SAMPLE
-            ESP_LOGI(TAG_APP, "JSON promedio/debug: %s", json);
-    #endif
-
-            // --- Envío a Hostinger con hasta 3 intentos ---
-            int rc = -1;
-            for (int attempt = 1; attempt <= HOSTINGER_POST_MAX_RETRIES; ++attempt) {
-                const char *payload = json;
-                if (first_send && attempt > 1 && has_retry_no_ver) {
-                    payload = json_retry_no_ver;
-                }
-                rc = hostinger_ingest_post(payload);
-                if (rc == 0) {
-                    if (attempt > 1) {
-                        ESP_LOGW(TAG_APP,
-                                "Envío a Hostinger exitoso en intento %d/%d",
-                                attempt, HOSTINGER_POST_MAX_RETRIES);
-                    }
-                    break;
-                }
-
-                ESP_LOGE(TAG_APP,
-                        "Falló envío a Hostinger rc=%d (intento %d/%d)",
-                        rc, attempt, HOSTINGER_POST_MAX_RETRIES);
+            esp_err_t geo_reset_err = geo_cache_reset_daily_state();
+            if (geo_reset_err == ESP_OK) {
+                geo_state.geo_success_today = false;
+                geo_state.geo_rate_limited_today = false;
+                geo_state.geo_attempt_count_today = 0;
+                next_geo_retry_ms = 0;
+                ESP_LOGI(TAG_APP,
+                         "Cambio de dia detectado (%s). Estado geo diario reiniciado",
+                         fecha_actual);
+            } else {
+                ESP_LOGW(TAG_APP,
+                         "Cambio de dia detectado (%s), pero no se pudo reiniciar estado geo: %s",
+                         fecha_actual,
+                         esp_err_to_name(geo_reset_err));
+            }
 
-                if (attempt < HOSTINGER_POST_MAX_RETRIES) {
-                    vTaskDelay(pdMS_TO_TICKS(HOSTINGER_POST_RETRY_DELAY_MS));
-                }
+            if (system_time_is_valid()) {
+                ESP_LOGI(TAG_APP,
+                         "Cambio de dia detectado (%s). Verificacion OTA diaria",
+                         fecha_actual);
+                modem_ppp_force_public_dns();
+                ota_check_and_update_if_needed();
+            } else {
+                ESP_LOGW(TAG_APP,
+                         "Cambio de dia detectado (%s), pero la hora no es valida. OTA diaria omitida",
+                         fecha_actual);
             }
+        }
 
-            if (rc != 0) {
-                ESP_LOGE(TAG_APP,
-                        "Fallaron %d intentos consecutivos a Hostinger. Reiniciando ESP32...",
-                        HOSTINGER_POST_MAX_RETRIES);
-                vTaskDelay(pdMS_TO_TICKS(HOSTINGER_POST_RETRY_DELAY_MS));
-                esp_restart();
+        if (UNWIREDLABS_TOKEN[0]) {
+            int64_t now_ms = monotonic_ms();
+            bool should_try_geo = false;
+
+            if (geo_state.geo_success_today) {
+                ESP_LOGI(TAG_APP, "Geo: ya hubo exito hoy, no se reintenta");
+            } else if (geo_state.geo_rate_limited_today) {
+                ESP_LOGI(TAG_APP, "Geo: bloqueado hoy por rate limit");
+            } else if (geo_state.geo_attempt_count_today >= GEO_MAX_ATTEMPTS_PER_DAY) {
+                ESP_LOGI(TAG_APP, "Geo: maximo diario de intentos alcanzado (%u)",
+                         geo_state.geo_attempt_count_today);
+            } else if (next_geo_retry_ms > now_ms) {
+                int64_t remaining_ms = next_geo_retry_ms - now_ms;
+                ESP_LOGI(TAG_APP,
+                         "Geo: reintento aun no corresponde, faltan %lld s",
+                         (long long)(remaining_ms / 1000));
+            } else {
+                should_try_geo = true;
             }
 
-            if (day_changed) {
-                esp_err_t geo_reset_err = geo_cache_reset_daily_state();
-                if (geo_reset_err == ESP_OK) {
-                    geo_state.geo_success_today = false;
+            if (should_try_geo) {
+                char city[64] = "";
+                char state[64] = "";
+                ESP_LOGI(TAG_APP, "Geo: intentando geolocalizacion post-envio");
+                geo_try_result_t geo_result = geo_try_once(city, sizeof(city),
+                                                           state, sizeof(state));
+
+                if (geo_result == GEO_TRY_DNS_NOT_READY) {
+                    next_geo_retry_ms = now_ms + GEO_RETRY_AFTER_DNS_MS;
+                    ESP_LOGW(TAG_APP,
+                             "Geo: DNS no listo, no consume intento. Reintento en %d min",
+                             GEO_RETRY_AFTER_DNS_MS / 60000);
+                } else if (geo_result == GEO_TRY_OK) {
+                    build_city_hyphen(g_city, sizeof(g_city), city, state);
+                    apply_city_to_runtime(g_city);
+
+                    geo_state.geo_attempt_count_today++;
+                    geo_state.geo_success_today = true;
                     geo_state.geo_rate_limited_today = false;
-                    geo_state.geo_attempt_count_today = 0;
                     next_geo_retry_ms = 0;
-                    ESP_LOGI(TAG_APP,
-                             "Cambio de dia detectado (%s). Estado geo diario reiniciado",
-                             fecha_actual);
-                } else {
-                    ESP_LOGW(TAG_APP,
-                             "Cambio de dia detectado (%s), pero no se pudo reiniciar estado geo: %s",
-                             fecha_actual,
-                             esp_err_to_name(geo_reset_err));
-                }
 
-                if (system_time_is_valid()) {
+                    (void)geo_cache_store_last_city(g_city);
+                    (void)geo_cache_set_daily_state(geo_state.geo_success_today,
+                                                    geo_state.geo_rate_limited_today,
+                                                    geo_state.geo_attempt_count_today);
                     ESP_LOGI(TAG_APP,
-                             "Cambio de dia detectado (%s). Verificacion OTA diaria",
-                             fecha_actual);
-                    modem_ppp_force_public_dns();
-                    ota_check_and_update_if_needed();
-                } else {
-                    ESP_LOGW(TAG_APP,
-                             "Cambio de dia detectado (%s), pero la hora no es valida. OTA diaria omitida",
-                             fecha_actual);
-                }
-            }
-
-            if (UNWIREDLABS_TOKEN[0]) {
-                int64_t now_ms = monotonic_ms();
-                bool should_try_geo = false;
+                             "Geo: exito, ciudad actualizada a %s (attempts=%u)",
+                             g_city,
+                             geo_state.geo_attempt_count_today);
+                } else if (geo_result == GEO_TRY_RATE_LIMIT) {
+                    geo_state.geo_attempt_count_today++;
+                    geo_state.geo_success_today = false;
+                    geo_state.geo_rate_limited_today = true;
+                    next_geo_retry_ms = 0;
 
-                if (geo_state.geo_success_today) {
-                    ESP_LOGI(TAG_APP, "Geo: ya hubo exito hoy, no se reintenta");
-                } else if (geo_state.geo_rate_limited_today) {
-                    ESP_LOGI(TAG_APP, "Geo: bloqueado hoy por rate limit");
-                } else if (geo_state.geo_attempt_count_today >= GEO_MAX_ATTEMPTS_PER_DAY) {
-                    ESP_LOGI(TAG_APP, "Geo: maximo diario de intentos alcanzado (%u)",
+                    (void)geo_cache_set_daily_state(geo_state.geo_success_today,
+                                                    geo_state.geo_rate_limited_today,
+                                                    geo_state.geo_attempt_count_today);
+                    ESP_LOGW(TAG_APP,
+                             "Geo: rate limit detectado, se bloquea resto del dia (attempts=%u)",
                              geo_state.geo_attempt_count_today);
-                } else if (next_geo_retry_ms > now_ms) {
-                    int64_t remaining_ms = next_geo_retry_ms - now_ms;
-                    ESP_LOGI(TAG_APP,
-                             "Geo: reintento aun no corresponde, faltan %lld s",
-                             (long long)(remaining_ms / 1000));
                 } else {
-                    should_try_geo = true;
-                }
+                    geo_state.geo_attempt_count_today++;
+                    geo_state.geo_success_today = false;
+                    geo_state.geo_rate_limited_today = false;
 
-                if (should_try_geo) {
-                    char city[64] = "";
-                    char state[64] = "";
-                    ESP_LOGI(TAG_APP, "Geo: intentando geolocalizacion post-envio");
-                    geo_try_result_t geo_result = geo_try_once(city, sizeof(city),
-                                                               state, sizeof(state));
+                    (void)geo_cache_set_daily_state(geo_state.geo_success_today,
+                                                    geo_state.geo_rate_limited_today,
+                                                    geo_state.geo_attempt_count_today);
 
-                    if (geo_result == GEO_TRY_DNS_NOT_READY) {
-                        next_geo_retry_ms = now_ms + GEO_RETRY_AFTER_DNS_MS;
+                    if (geo_state.geo_attempt_count_today < GEO_MAX_ATTEMPTS_PER_DAY) {
+                        next_geo_retry_ms = now_ms + GEO_RETRY_AFTER_FAIL_MS;
                         ESP_LOGW(TAG_APP,
-                                 "Geo: DNS no listo, no consume intento. Reintento en %d min",
-                                 GEO_RETRY_AFTER_DNS_MS / 60000);
-                    } else if (geo_result == GEO_TRY_OK) {
-                        build_city_hyphen(g_city, sizeof(g_city), city, state);
-                        apply_city_to_runtime(g_city);
-
-                        geo_state.geo_attempt_count_today++;
-                        geo_state.geo_success_today = true;
-                        geo_state.geo_rate_limited_today = false;
-                        next_geo_retry_ms = 0;
-
-                        (void)geo_cache_store_last_city(g_city);
-                        (void)geo_cache_set_daily_state(geo_state.geo_success_today,
-                                                        geo_state.geo_rate_limited_today,
-                                                        geo_state.geo_attempt_count_today);
-                        ESP_LOGI(TAG_APP,
-                                 "Geo: exito, ciudad actualizada a %s (attempts=%u)",
-                                 g_city,
-                                 geo_state.geo_attempt_count_today);
-                    } else if (geo_result == GEO_TRY_RATE_LIMIT) {
-                        geo_state.geo_attempt_count_today++;
-                        geo_state.geo_success_today = false;
-                        geo_state.geo_rate_limited_today = true;
+                                 "Geo: fallo no-DNS, intento consumido. Reintento en %d h",
+                                 GEO_RETRY_AFTER_FAIL_MS / (60 * 60 * 1000));
+                    } else {
                         next_geo_retry_ms = 0;
-
-                        (void)geo_cache_set_daily_state(geo_state.geo_success_today,
-                                                        geo_state.geo_rate_limited_today,
-                                                        geo_state.geo_attempt_count_today);
                         ESP_LOGW(TAG_APP,
-                                 "Geo: rate limit detectado, se bloquea resto del dia (attempts=%u)",
+                                 "Geo: fallo no-DNS y se alcanzo maximo diario (%u)",
                                  geo_state.geo_attempt_count_today);
-                    } else {
-                        geo_state.geo_attempt_count_today++;
-                        geo_state.geo_success_today = false;
-                        geo_state.geo_rate_limited_today = false;
-
-                        (void)geo_cache_set_daily_state(geo_state.geo_success_today,
-                                                        geo_state.geo_rate_limited_today,
-                                                        geo_state.geo_attempt_count_today);
-
-                        if (geo_state.geo_attempt_count_today < GEO_MAX_ATTEMPTS_PER_DAY) {
-                            next_geo_retry_ms = now_ms + GEO_RETRY_AFTER_FAIL_MS;
-                            ESP_LOGW(TAG_APP,
-                                     "Geo: fallo no-DNS, intento consumido. Reintento en %d h",
-                                     GEO_RETRY_AFTER_FAIL_MS / (60 * 60 * 1000));
-                        } else {
-                            next_geo_retry_ms = 0;
-                            ESP_LOGW(TAG_APP,
-                                     "Geo: fallo no-DNS y se alcanzo maximo diario (%u)",
-                                     geo_state.geo_attempt_count_today);
-                        }
                     }
                 }
             }
-
-            if (include_fecha) {
-                strncpy(last_fecha_str, fecha_actual, sizeof(last_fecha_str) - 1);
-                last_fecha_str[sizeof(last_fecha_str) - 1] = '\0';
-            }
-            first_send = false;
-
-            sample_slot = 0;
-            sum_co2 = 0;
-            scd40_ok_count_5m = 0;
-            sen55_valid_count_5m = 0;
-            sum_pm1p0 = sum_pm2p5 = sum_pm4p0 = sum_pm10p0 = 0;
-            sum_voc   = sum_nox   = sum_sen_temp = sum_sen_hum = 0;
-            sum_avg_temp = sum_avg_hum = 0;
         }
 
-        vTaskDelay(SAMPLE_DELAY_TICKS);
+        if (include_fecha) {
+            last_day = day;
+        }
+        first_send = false;
     }
 }
 
@@ -561,10 +1100,35 @@ void app_main(void)
         ESP_ERROR_CHECK(nvs_flash_init());
     }
 
+    if (raw_capture_init() != ESP_OK) {
+        ESP_LOGW(TAG_APP, "Captura cruda no disponible");
+    }
+
+    esp_err_t qret = upload_queue_init();
+    if (qret == ESP_ERR_NOT_FOUND) {
+        // Equipos actualizados por OTA conservan la tabla de particiones
+        // vieja (sin upq): hay que regrabarlos por serie con partitions.csv
+        ESP_LOGE(TAG_APP, "************************************************************");
+        ESP_LOGE(TAG_APP, "SIN PARTICION '%s': la tabla de particiones es anterior a la",
+                 UPLOAD_QUEUE_PARTITION_LABEL);
+        ESP_LOGE(TAG_APP, "cola flash. Regrabar por serie (idf.py flash). Mientras tanto");
+        ESP_LOGE(TAG_APP, "un envío fallido reinicia el equipo como antes.");
+        ESP_LOGE(TAG_APP, "************************************************************");
+    } else if (qret != ESP_OK) {
+        ESP_LOGE(TAG_APP, "Cola de envíos en flash no disponible: %s",
+                 esp_err_to_name(qret));
+    }
+
+    if (INGEST_GZIP_MIN_BYTES > 0 &&
+        hostinger_ingest_set_gzip(INGEST_GZIP_MIN_BYTES) != ESP_OK) {
+        ESP_LOGW(TAG_APP, "Sin memoria para gzip; se envía sin comprimir");
+    }
+
     const esp_app_desc_t *app_desc = esp_app_get_description();
     if (app_desc && app_desc->version[0]) {
         strlcpy(g_firmware_ver, app_desc->version, sizeof(g_firmware_ver));
     }
+    payload_json_init(g_firmware_ver, DEVICE_ID);
     ESP_LOGI(TAG_APP, "Version local firmware: %s", app_desc->version);
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -634,17 +1198,38 @@ void app_main(void)
     }
 
     // === 6) Sensores y task de envio a Hostinger (ya SIN Firebase) ===
+    // Las tareas arrancan igual: un sensor que falló al iniciar se re-agrega
+    // solo (sensors_init_all) y upload_task sigue atendiendo cola, OTA y
+    // telemetría mientras tanto
     esp_err_t sret = sensors_init_all();
     if (sret != ESP_OK) {
         ESP_LOGE(TAG_APP, "Fallo al inicializar sensores: %s",
                  esp_err_to_name(sret));
-    } else {
-        xTaskCreate(sensor_task,
-                    "sensor_task",
-                    SENSOR_TASK_STACK,
-                    NULL,
-                    5,
-                    NULL);
     }
+    sensors_scd40_set_mode(sensors_scd40_mode_for_period(SCD_SAMPLE_MS));
+    s_window_q = xQueueCreate(WINDOW_QUEUE_LEN, sizeof(window_record_t));
+    if (!s_window_q) {
+        ESP_LOGE(TAG_APP, "Sin memoria para la cola de ventanas");
+        return;
+    }
+    xTaskCreate(upload_task,
+                "upload_task",
+                UPLOAD_TASK_STACK,
+                NULL,
+                4,
+                NULL);
+    // El consumidor se suscribe al ring antes de que haya muestras
+    xTaskCreate(agg_task,
+                "agg_task",
+                AGG_TASK_STACK,
+                NULL,
+                4,
+                NULL);
+    xTaskCreate(sensor_task,
+                "sensor_task",
+                SENSOR_TASK_STACK,
+                NULL,
+                5,
+                NULL);
 }
 
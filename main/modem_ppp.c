@@ -26,6 +26,7 @@
 /* ==== HTTP (UnwiredLabs) ==== */
 #include "esp_http_client.h"
 #include "esp_crt_bundle.h"
+#include "hostinger_latency.h"
 #include "esp_timer.h"
 #include "Privado.h"                // define UNWIREDLABS_TOKEN (tu archivo)
 
@@ -331,8 +332,11 @@ static char ul_body[UL_BODY_MAX];   // respuesta (JSON)
 
 typedef struct { char *buf; int max; int len; } ul_accum_t;
 
+static hostinger_lat_probe_t s_ul_lat;
+
 static esp_err_t ul_http_evt(esp_http_client_event_t *evt) {
     ul_accum_t *acc = (ul_accum_t *)evt->user_data;
+    hostinger_lat_event(&s_ul_lat, evt);
     if (evt->event_id == HTTP_EVENT_ON_DATA && acc && acc->buf && evt->data && evt->data_len) {
         int room = acc->max - acc->len - 1;
         int n = (evt->data_len < room) ? evt->data_len : room;
@@ -452,9 +456,12 @@ esp_err_t modem_unwiredlabs_city_state_once(char *city, size_t city_len,
     esp_http_client_set_header(cli, "Content-Type", "application/json");
     esp_http_client_set_post_field(cli, payload, plen);
 
+    hostinger_lat_begin(&s_ul_lat, HOSTINGER_LAT_GEO);
+    hostinger_lat_dns(&s_ul_lat, UNWIRED_URL);
     int64_t t0 = esp_timer_get_time();
     esp_err_t err = esp_http_client_perform(cli);
     int64_t t1 = esp_timer_get_time();
+    hostinger_lat_end(&s_ul_lat, err == ESP_OK);
 
     int status = esp_http_client_get_status_code(cli);
     int cl = esp_http_client_get_content_length(cli);
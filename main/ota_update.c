@@ -17,6 +17,7 @@
 #include "esp_https_ota.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "hostinger_latency.h"
 
 static const char *TAG = "OTA_UPDATE";
 
@@ -46,6 +47,8 @@ typedef enum {
     OTA_CHECK_RESULT_RETRY,
 } ota_check_result_t;
 
+static hostinger_lat_probe_t s_ota_lat;
+
 static esp_err_t http_buffer_append(http_buffer_t *buffer, const char *data, int data_len) {
     if (!buffer || !data || data_len <= 0) {
         return ESP_OK;
@@ -76,6 +79,7 @@ static esp_err_t http_buffer_append(http_buffer_t *buffer, const char *data, int
 
 static esp_err_t manifest_http_event_handler(esp_http_client_event_t *evt) {
     http_buffer_t *buffer = (http_buffer_t *)evt->user_data;
+    hostinger_lat_event(&s_ota_lat, evt);
 
     if (evt->event_id == HTTP_EVENT_ON_DATA) {
         return http_buffer_append(buffer, (const char *)evt->data, evt->data_len);
@@ -108,8 +112,11 @@ static esp_err_t http_get_manifest(char **out_body) {
 
     esp_http_client_set_method(client, HTTP_METHOD_GET);
 
+    hostinger_lat_begin(&s_ota_lat, HOSTINGER_LAT_OTA);
+    hostinger_lat_dns(&s_ota_lat, OTA_MANIFEST_URL);
     esp_err_t err = esp_http_client_perform(client);
     int status = esp_http_client_get_status_code(client);
+    hostinger_lat_end(&s_ota_lat, err == ESP_OK);
     esp_http_client_cleanup(client);
 
     if (err != ESP_OK) {
@@ -235,12 +242,18 @@ static void log_time_warning_if_needed(void) {
     }
 }
 
+static esp_err_t ota_http_event_handler(esp_http_client_event_t *evt) {
+    hostinger_lat_event(&s_ota_lat, evt);
+    return ESP_OK;
+}
+
 static esp_err_t perform_https_ota(const char *firmware_url) {
     esp_http_client_config_t http_config = {
         .url = firmware_url,
         .crt_bundle_attach = esp_crt_bundle_attach,
         .timeout_ms = 30000,
         .keep_alive_enable = true,
+        .event_handler = ota_http_event_handler,
     };
 
     esp_https_ota_config_t ota_config = {
@@ -248,7 +261,11 @@ static esp_err_t perform_https_ota(const char *firmware_url) {
     };
 
     ESP_LOGI(TAG, "Iniciando OTA desde %s", firmware_url);
-    return esp_https_ota(&ota_config);
+    hostinger_lat_begin(&s_ota_lat, HOSTINGER_LAT_OTA);
+    hostinger_lat_dns(&s_ota_lat, firmware_url);
+    esp_err_t err = esp_https_ota(&ota_config);
+    hostinger_lat_end(&s_ota_lat, err == ESP_OK);   // body = descarga + escritura en flash
+    return err;
 }
 
 const char *ota_update_get_manifest_url(void) {
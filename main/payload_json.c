@@ -0,0 +1,303 @@
+#include "payload_json.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "fixed_fmt.h"
+#include "robust_agg.h"
+#include "sensor_fields.h"
+
+static const char *TAG = "PAYLOAD";
+
+// Fragmentos pre-renderizados: ,"clave":"valor"
+static char s_frag_ver[48];
+static char s_frag_device_id[64];
+static char s_frag_inicio[32];
+static char s_frag_city[96];
+
+// Cursor de escritura: al primer desborde queda en !ok y no escribe más
+typedef struct {
+    char  *buf;
+    size_t len;
+    size_t pos;
+    bool   ok;
+} json_out_t;
+
+static void out_raw(json_out_t *o, const char *s, size_t n)
+{
+    if (!o->ok) {
+        return;
+    }
+    if (n >= o->len - o->pos) {
+        o->ok = false;
+        return;
+    }
+    memcpy(o->buf + o->pos, s, n);
+    o->pos += n;
+}
+
+static void out_str(json_out_t *o, const char *s)
+{
+    out_raw(o, s, strlen(s));
+}
+
+// ,"key": (o {"key": si es el primero del objeto)
+static void out_key(json_out_t *o, const char *key, bool first)
+{
+    out_raw(o, first ? "\"" : ",\"", first ? 1 : 2);
+    out_str(o, key);
+    out_raw(o, "\":", 2);
+}
+
+static void out_fixed(json_out_t *o, float v, int decimals)
+{
+    char tmp[48];
+    int n = fixed_fmt_float(tmp, sizeof(tmp), v, decimals);
+    if (n <= 0) {
+        o->ok = false;
+        return;
+    }
+    out_raw(o, tmp, (size_t)n);
+}
+
+static void out_uint(json_out_t *o, uint32_t v)
+{
+    char tmp[12];
+    int pos = sizeof(tmp);
+    do {
+        tmp[--pos] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    out_raw(o, tmp + pos, sizeof(tmp) - (size_t)pos);
+}
+
+// ,"key":"value" (value sin escapar: fechas/horas propias)
+static void out_str_member(json_out_t *o, const char *key, const char *value)
+{
+    out_key(o, key, false);
+    out_raw(o, "\"", 1);
+    out_str(o, value);
+    out_raw(o, "\"", 1);
+}
+
+// Renderiza ,"key":"value" escapando comillas, barras y controles
+static void render_frag(char *dst, size_t dst_len, const char *key, const char *value)
+{
+    json_out_t o = { .buf = dst, .len = dst_len, .ok = true };
+    out_key(&o, key, false);
+    out_raw(&o, "\"", 1);
+    for (const char *p = value ? value : ""; *p; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            char esc[2] = { '\\', (char)c };
+            out_raw(&o, esc, 2);
+        } else if (c < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out_raw(&o, esc, 6);
+        } else {
+            out_raw(&o, (const char *)p, 1);
+        }
+    }
+    out_raw(&o, "\"", 1);
+    if (!o.ok) {
+        ESP_LOGW(TAG, "%s demasiado largo; se omite", key);
+        o.pos = 0;
+    }
+    dst[o.pos] = '\0';
+}
+
+void payload_json_init(const char *ver, const char *device_id)
+{
+    render_frag(s_frag_ver, sizeof(s_frag_ver), "ver", ver);
+    render_frag(s_frag_device_id, sizeof(s_frag_device_id), "device_id", device_id);
+}
+
+void payload_json_set_inicio(const char *inicio)
+{
+    render_frag(s_frag_inicio, sizeof(s_frag_inicio), "inicio", inicio);
+}
+
+void payload_json_set_city(const char *city)
+{
+    render_frag(s_frag_city, sizeof(s_frag_city), "ciudad", city);
+}
+
+static bool field_is_dbg(int f)
+{
+    return f == SENSOR_FIELD_SEN_TEMP || f == SENSOR_FIELD_SEN_HUM;
+}
+
+static void write_agg(json_out_t *o, const uint8_t *agg)
+{
+    bool first = true;
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        if (agg[f] == WINDOW_AGG_MEAN) {
+            continue;
+        }
+        if (first) {
+            out_str(o, ",\"agg\":{");
+        }
+        out_key(o, g_sensor_fields[f].key, first);
+        out_raw(o, "\"", 1);
+        out_str(o, robust_agg_name((window_agg_t)agg[f]));
+        out_raw(o, "\"", 1);
+        first = false;
+    }
+    if (!first) {
+        out_raw(o, "}", 1);
+    }
+}
+
+static void write_counts(json_out_t *o, const window_field_summary_t *stats, uint32_t present)
+{
+    bool first = true;
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        if (!(present & (1u << f))) {
+            continue;
+        }
+        if (first) {
+            out_str(o, ",\"n\":{");
+        }
+        out_key(o, g_sensor_fields[f].key, first);
+        out_uint(o, stats[f].used);
+        first = false;
+    }
+    if (!first) {
+        out_raw(o, "}", 1);
+    }
+}
+
+static void write_stats(json_out_t *o, const window_field_summary_t *stats)
+{
+    out_str(o, ",\"stats\":{");
+    bool first = true;
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        const window_field_summary_t *st = &stats[f];
+        if (st->n == 0) {
+            continue;
+        }
+        int d = g_sensor_fields[f].decimals;
+        out_key(o, g_sensor_fields[f].key, first);
+        out_raw(o, "[", 1);
+        out_uint(o, st->n);
+        out_raw(o, ",", 1);
+        out_fixed(o, st->std, d);
+        out_raw(o, ",", 1);
+        out_fixed(o, st->min, d);
+        out_raw(o, ",", 1);
+        out_fixed(o, st->max, d);
+        out_raw(o, "]", 1);
+        first = false;
+    }
+    out_raw(o, "}", 1);
+}
+
+// Sección opcional al final: si no entra se vuelve atrás y se sigue sin ella
+typedef void (*section_fn_t)(json_out_t *o, const payload_json_src_t *src);
+
+static void section_agg(json_out_t *o, const payload_json_src_t *src)
+{
+    write_agg(o, src->agg);
+}
+
+static void section_counts(json_out_t *o, const payload_json_src_t *src)
+{
+    write_counts(o, src->stats, src->present);
+}
+
+static void section_stats(json_out_t *o, const payload_json_src_t *src)
+{
+    write_stats(o, src->stats);
+}
+
+static void write_optional(json_out_t *o, const payload_json_src_t *src, section_fn_t fn,
+                           const char *name)
+{
+    size_t mark = o->pos;
+    fn(o, src);
+    // Lugar para la llave de cierre
+    if (o->ok && o->len - o->pos < 2) {
+        o->ok = false;
+    }
+    if (!o->ok) {
+        ESP_LOGW(TAG, "Sin espacio para %s en el JSON", name);
+        o->pos = mark;
+        o->ok = true;
+    }
+}
+
+int payload_json_write(const payload_json_src_t *src, uint32_t flags, char *buf, size_t len)
+{
+    if (!src || !src->avg || !buf || len == 0) {
+        return -1;
+    }
+
+    json_out_t o = { .buf = buf, .len = len, .ok = true };
+    out_raw(&o, "{", 1);
+
+    bool first = true;
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        if (field_is_dbg(f) && !(flags & PAYLOAD_JSON_DBG)) {
+            continue;
+        }
+        out_key(&o, g_sensor_fields[f].key, first);
+        out_fixed(&o, sensor_field_get(src->avg, (sensor_field_t)f), g_sensor_fields[f].decimals);
+        first = false;
+    }
+
+    if (flags & PAYLOAD_JSON_VER) {
+        out_str(&o, s_frag_ver);
+    }
+    if ((flags & PAYLOAD_JSON_FECHA) && src->fecha) {
+        out_str_member(&o, "fecha", src->fecha);
+    }
+    if (flags & PAYLOAD_JSON_INICIO) {
+        if (src->inicio) {
+            out_str_member(&o, "inicio", src->inicio);
+        } else {
+            out_str(&o, s_frag_inicio);
+        }
+    }
+    if (flags & PAYLOAD_JSON_CIUDAD) {
+        out_str(&o, s_frag_city[0] ? s_frag_city : ",\"ciudad\":\"----\"");
+    }
+    if (src->hora) {
+        out_str_member(&o, "hora", src->hora);
+    }
+    if (flags & PAYLOAD_JSON_DEVICE_ID) {
+        out_str(&o, s_frag_device_id);
+    }
+    if (flags & PAYLOAD_JSON_EPOCH) {
+        out_key(&o, "ts", false);
+        out_raw(&o, "[", 1);
+        out_uint(&o, src->start_epoch);
+        out_raw(&o, ",", 1);
+        out_uint(&o, src->end_epoch);
+        out_raw(&o, "]", 1);
+    }
+    if (!o.ok) {
+        buf[0] = '\0';
+        return -1;
+    }
+
+    if ((flags & PAYLOAD_JSON_AGG) && src->agg) {
+        write_optional(&o, src, section_agg, "agg");
+    }
+    if ((flags & PAYLOAD_JSON_COUNTS) && src->stats) {
+        write_optional(&o, src, section_counts, "n");
+    }
+    if ((flags & PAYLOAD_JSON_STATS) && src->stats) {
+        write_optional(&o, src, section_stats, "stats");
+    }
+
+    out_raw(&o, "}", 1);
+    if (!o.ok) {
+        buf[0] = '\0';
+        return -1;
+    }
+    buf[o.pos] = '\0';
+    return (int)o.pos;
+}
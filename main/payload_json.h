@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensors.h"
+#include "window.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Serializador único del JSON de ingest. Recorre g_sensor_fields (clave y
+// decimales por campo) y escribe en una sola pasada sobre el buffer del
+// llamador; las secciones opcionales se eligen con PAYLOAD_JSON_*. Lo que
+// no cambia entre ventanas (ver, device_id, inicio, ciudad) se renderiza,
+// ya escapado, una sola vez al fijarlo.
+//
+// Orden: campos, dbg, ver, fecha, inicio, ciudad, hora, device_id, ts, agg,
+// n, stats. Si agg/n/stats no entran se omiten (con aviso) y el resto sale.
+
+#define PAYLOAD_JSON_DBG        0x0001  // sen55_temp_dbg / sen55_hum_dbg
+#define PAYLOAD_JSON_VER        0x0002
+#define PAYLOAD_JSON_FECHA      0x0004
+#define PAYLOAD_JSON_INICIO     0x0008
+#define PAYLOAD_JSON_CIUDAD     0x0010
+#define PAYLOAD_JSON_DEVICE_ID  0x0020
+#define PAYLOAD_JSON_AGG        0x0040  // "agg":{campo:"hampel",...} (no media)
+#define PAYLOAD_JSON_COUNTS     0x0080  // "n":{campo:muestras usadas,...}
+#define PAYLOAD_JSON_STATS      0x0100  // "stats":{campo:[n,std,min,max],...}
+#define PAYLOAD_JSON_EPOCH      0x0200  // "ts":[inicio,fin] en epoch UTC
+
+typedef struct {
+    const SensorData *avg;
+    const window_field_summary_t *stats;  // COUNTS/STATS (NULL = se omiten)
+    const uint8_t *agg;                   // AGG (NULL = se omite)
+    uint32_t    present;                  // bits (1 << sensor_field_t) para COUNTS
+    const char *fecha;                    // "DD-MM-YYYY"
+    const char *hora;                     // "HH:MM:SS"; NULL = sin "hora"
+    const char *inicio;                   // NULL = el fijado con payload_json_set_inicio
+    uint32_t    start_epoch;              // EPOCH
+    uint32_t    end_epoch;
+} payload_json_src_t;
+
+// Fragmentos fijos; ver y device_id al arrancar
+void payload_json_init(const char *ver, const char *device_id);
+void payload_json_set_inicio(const char *inicio);
+void payload_json_set_city(const char *city);
+
+// Devuelve la longitud escrita (sin el '\0') o -1 si ni lo obligatorio entra
+int payload_json_write(const payload_json_src_t *src, uint32_t flags, char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
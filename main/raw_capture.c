@@ -0,0 +1,229 @@
+#include "raw_capture.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sensors.h"
+#include "ts_codec.h"
+
+static const char *TAG = "RAW_CAP";
+
+typedef enum {
+    BLOCK_FREE = 0,
+    BLOCK_FILLING,
+    BLOCK_READY,
+} block_state_t;
+
+typedef struct {
+    block_state_t state;
+    uint8_t  buf[RAW_CAPTURE_BLOCK_LEN];
+    size_t   len;             // READY: bytes del bloque
+    uint32_t capture_id;
+    uint16_t seq;
+    int64_t  t0_us;           // t_us de la primera muestra (tiempos del bloque)
+    ts_enc_t enc;
+} raw_block_t;
+
+static raw_block_t s_blocks[RAW_CAPTURE_N_BLOCKS];
+static SemaphoreHandle_t s_lock = NULL;
+static raw_capture_stats_t s_stats;
+static uint16_t s_next_seq;
+static int s_peeked = -1;        // bloque reservado por raw_capture_peek
+
+esp_err_t raw_capture_init(void)
+{
+    if (s_lock) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    return s_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static raw_block_t *block_in(block_state_t state)
+{
+    for (int i = 0; i < RAW_CAPTURE_N_BLOCKS; ++i) {
+        if (s_blocks[i].state == state) {
+            return &s_blocks[i];
+        }
+    }
+    return NULL;
+}
+
+// Cierra el bloque en curso; vacío vuelve a libre
+static void block_close(raw_block_t *b)
+{
+    if (b->enc.count == 0) {
+        b->state = BLOCK_FREE;
+        return;
+    }
+    b->len = ts_enc_finish(&b->enc);
+    b->state = BLOCK_READY;
+    s_stats.blocks++;
+    ESP_LOGI(TAG, "Bloque %u cerrado: %u muestras, %u bytes",
+             (unsigned)b->seq, (unsigned)b->enc.count, (unsigned)b->len);
+}
+
+static raw_block_t *block_open(const sample_t *smp)
+{
+    raw_block_t *b = block_in(BLOCK_FREE);
+    if (!b) {
+        return NULL;
+    }
+    ts_enc_init(&b->enc, b->buf, sizeof(b->buf), (uint16_t)sensors_present_fields(),
+                (uint32_t)smp->epoch);
+    b->state = BLOCK_FILLING;
+    b->capture_id = s_stats.capture_id;
+    b->seq = s_next_seq++;
+    b->t0_us = smp->t_us;
+    return b;
+}
+
+static esp_err_t block_add(raw_block_t *b, const sample_t *smp)
+{
+    uint32_t t_ms = (uint32_t)((smp->t_us - b->t0_us) / 1000);
+    return ts_enc_add(&b->enc, t_ms, smp->flags, &smp->data);
+}
+
+static void capture_finish_locked(void)
+{
+    raw_block_t *b = block_in(BLOCK_FILLING);
+    if (b) {
+        block_close(b);
+    }
+    s_stats.active = false;
+    ESP_LOGI(TAG, "Captura %u terminada: %u muestras, %u descartadas",
+             (unsigned)s_stats.capture_id, (unsigned)s_stats.samples,
+             (unsigned)s_stats.dropped);
+}
+
+bool raw_capture_start(uint32_t duration_s, const char *reason)
+{
+    if (!s_lock || duration_s == 0) {
+        return false;
+    }
+    if (duration_s > RAW_CAPTURE_MAX_S) {
+        duration_s = RAW_CAPTURE_MAX_S;
+    }
+    uint32_t now = (uint32_t)time(NULL);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool started = !s_stats.active;
+    if (started) {
+        s_stats.active = true;
+        s_stats.capture_id = now;
+        s_stats.samples = 0;
+        s_stats.dropped = 0;
+        s_next_seq = 0;
+        s_stats.end_epoch = now + duration_s;
+    } else {
+        // Extiende sin pasar el tope desde el inicio
+        uint32_t end = now + duration_s;
+        uint32_t limit = s_stats.capture_id + RAW_CAPTURE_MAX_S;
+        if (end > limit) {
+            end = limit;
+        }
+        if (end > s_stats.end_epoch) {
+            s_stats.end_epoch = end;
+        }
+    }
+    uint32_t end_epoch = s_stats.end_epoch;
+    xSemaphoreGive(s_lock);
+
+    ESP_LOGI(TAG, "Captura %s (%s): hasta epoch %u",
+             started ? "iniciada" : "extendida", reason ? reason : "-", (unsigned)end_epoch);
+    return started;
+}
+
+bool raw_capture_active(void)
+{
+    return s_stats.active;
+}
+
+void raw_capture_add(const sample_t *smp)
+{
+    if (!s_lock || !s_stats.active) {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_stats.active && (uint32_t)smp->epoch >= s_stats.end_epoch) {
+        capture_finish_locked();
+    }
+    if (s_stats.active) {
+        raw_block_t *b = block_in(BLOCK_FILLING);
+        if (!b) {
+            b = block_open(smp);
+        }
+        if (b && block_add(b, smp) == ESP_ERR_NO_MEM) {
+            block_close(b);
+            b = block_open(smp);
+            if (b && block_add(b, smp) != ESP_OK) {
+                b = NULL;
+            }
+        }
+        if (b) {
+            s_stats.samples++;
+        } else {
+            s_stats.dropped++;
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
+
+const uint8_t *raw_capture_peek(size_t *len, uint32_t *capture_id, uint16_t *seq)
+{
+    if (!s_lock) {
+        return NULL;
+    }
+
+    const uint8_t *out = NULL;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    // El bloque más viejo primero
+    int best = -1;
+    for (int i = 0; i < RAW_CAPTURE_N_BLOCKS; ++i) {
+        const raw_block_t *b = &s_blocks[i];
+        if (b->state != BLOCK_READY) {
+            continue;
+        }
+        if (best < 0 || b->capture_id < s_blocks[best].capture_id ||
+            (b->capture_id == s_blocks[best].capture_id && b->seq < s_blocks[best].seq)) {
+            best = i;
+        }
+    }
+    if (best >= 0) {
+        s_peeked = best;
+        *len = s_blocks[best].len;
+        *capture_id = s_blocks[best].capture_id;
+        *seq = s_blocks[best].seq;
+        out = s_blocks[best].buf;
+    }
+    xSemaphoreGive(s_lock);
+    return out;
+}
+
+void raw_capture_release(bool sent)
+{
+    if (!s_lock) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (sent && s_peeked >= 0) {
+        s_blocks[s_peeked].state = BLOCK_FREE;
+    }
+    s_peeked = -1;
+    xSemaphoreGive(s_lock);
+}
+
+void raw_capture_get_stats(raw_capture_stats_t *out)
+{
+    if (!s_lock) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_stats;
+    xSemaphoreGive(s_lock);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sample_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Captura de muestras crudas por un tiempo acotado, para investigar
+// eventos sin subir siempre todo. Mientras está activa cada muestra del
+// ring (la que agg_task ya lee) se comprime con ts_codec en bloques de
+// RAW_CAPTURE_BLOCK_LEN; los bloques terminados esperan a que upload_task
+// los suba como stream aparte de las ventanas. Si los bloques no alcanzan
+// (envío atrasado) las muestras se descartan y se cuentan.
+//
+// Productor: agg_task (raw_capture_add). Consumidor: upload_task
+// (raw_capture_peek / raw_capture_release). raw_capture_start puede
+// llamarse desde cualquiera de las dos.
+
+#define RAW_CAPTURE_MAX_S      3600   // tope de una captura (se puede extender hasta acá)
+#define RAW_CAPTURE_BLOCK_LEN  1024   // ~80-100 muestras por bloque
+#define RAW_CAPTURE_N_BLOCKS   2
+
+typedef struct {
+    bool     active;
+    uint32_t capture_id;      // epoch de inicio de la captura
+    uint32_t end_epoch;
+    uint32_t samples;         // muestras guardadas en la captura actual
+    uint32_t dropped;         // sin bloque libre
+    uint32_t blocks;          // bloques cerrados
+} raw_capture_stats_t;
+
+esp_err_t raw_capture_init(void);
+
+// Arranca una captura de duration_s (acotada a RAW_CAPTURE_MAX_S) o, si ya
+// hay una, la extiende. reason solo va al log. Devuelve true si arrancó
+// una nueva.
+bool raw_capture_start(uint32_t duration_s, const char *reason);
+
+bool raw_capture_active(void);
+
+// Agrega la muestra si hay captura activa; cierra el bloque al llenarse y
+// la captura al vencer.
+void raw_capture_add(const sample_t *smp);
+
+// Próximo bloque terminado (NULL si no hay). El bloque queda reservado
+// hasta raw_capture_release: sent = false lo deja para reintentar.
+const uint8_t *raw_capture_peek(size_t *len, uint32_t *capture_id, uint16_t *seq);
+void raw_capture_release(bool sent);
+
+void raw_capture_get_stats(raw_capture_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
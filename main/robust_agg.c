@@ -0,0 +1,124 @@
+#include "robust_agg.h"
+
+#include <math.h>
+
+// Escala del MAD para que estime el desvío de una normal
+#define MAD_TO_SIGMA 1.4826f
+
+const char *robust_agg_name(window_agg_t agg)
+{
+    switch (agg) {
+    case WINDOW_AGG_MEDIAN:  return "median";
+    case WINDOW_AGG_TRIMMED: return "trim";
+    case WINDOW_AGG_HAMPEL:  return "hampel";
+    case WINDOW_AGG_MEAN:
+    default:                 return "mean";
+    }
+}
+
+static inline void swapf(float *a, float *b)
+{
+    float t = *a;
+    *a = *b;
+    *b = t;
+}
+
+// Deja en v[k] el k-ésimo menor; v[0..k) <= v[k] <= v(k..n)
+static float select_kth(float *v, size_t n, size_t k)
+{
+    size_t lo = 0, hi = n - 1;
+    while (lo < hi) {
+        // Pivote mediana de tres: evita el peor caso con ventanas ya ordenadas
+        size_t mid = lo + (hi - lo) / 2;
+        if (v[mid] < v[lo]) swapf(&v[mid], &v[lo]);
+        if (v[hi] < v[lo])  swapf(&v[hi], &v[lo]);
+        if (v[hi] < v[mid]) swapf(&v[hi], &v[mid]);
+        float pivot = v[mid];
+
+        size_t i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                swapf(&v[i], &v[j]);
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+    return v[k];
+}
+
+float robust_median(float *v, size_t n)
+{
+    if (n == 0) {
+        return 0.0f;
+    }
+    float upper = select_kth(v, n, n / 2);
+    if (n & 1) {
+        return upper;
+    }
+    // Par: la mediana inferior es el máximo de la mitad izquierda
+    float lower = v[0];
+    for (size_t i = 1; i < n / 2; ++i) {
+        if (v[i] > lower) lower = v[i];
+    }
+    return (lower + upper) / 2.0f;
+}
+
+float robust_trimmed_mean(float *v, size_t n, float trim)
+{
+    if (n == 0) {
+        return 0.0f;
+    }
+    size_t g = (size_t)((float)n * trim);
+    if (2 * g >= n) {
+        return robust_median(v, n);
+    }
+    if (g > 0) {
+        select_kth(v, n, g);                    // g menores a la izquierda
+        select_kth(v + g, n - g, n - 2 * g - 1); // g mayores a la derecha
+    }
+    double sum = 0;
+    for (size_t i = g; i < n - g; ++i) {
+        sum += v[i];
+    }
+    return (float)(sum / (double)(n - 2 * g));
+}
+
+float robust_hampel_mean(float *v, float *scratch, size_t n, float k, float min_mad,
+                         size_t *rejected)
+{
+    if (rejected) *rejected = 0;
+    if (n == 0) {
+        return 0.0f;
+    }
+    float med = robust_median(v, n);
+    for (size_t i = 0; i < n; ++i) {
+        scratch[i] = fabsf(v[i] - med);
+    }
+    float mad = robust_median(scratch, n);
+    if (mad < min_mad) {
+        mad = min_mad;
+    }
+    float limit = k * MAD_TO_SIGMA * mad;
+
+    double sum = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (fabsf(v[i] - med) <= limit) {
+            sum += v[i];
+            kept++;
+        }
+    }
+    if (rejected) *rejected = n - kept;
+    return kept ? (float)(sum / (double)kept) : med;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Agregadores resistentes a picos para el valor de una ventana. Trabajan
+// sobre el arreglo recibido (lo reordenan) con selección in situ
+// (quickselect, O(n) promedio), sin ordenar completo ni pedir memoria.
+
+typedef enum {
+    WINDOW_AGG_MEAN = 0,     // media aritmética (Welford)
+    WINDOW_AGG_MEDIAN,
+    WINDOW_AGG_TRIMMED,      // media sin el ROBUST_TRIM_FRACTION de cada extremo
+    WINDOW_AGG_HAMPEL,       // media de las muestras a <= ROBUST_HAMPEL_K MADs de la mediana
+} window_agg_t;
+
+#define ROBUST_TRIM_FRACTION  0.10f
+#define ROBUST_HAMPEL_K       3.0f
+
+// Nombre corto para el payload ("mean", "median", "trim", "hampel")
+const char *robust_agg_name(window_agg_t agg);
+
+float robust_median(float *v, size_t n);
+
+float robust_trimmed_mean(float *v, size_t n, float trim);
+
+// scratch debe tener lugar para n floats. *rejected = muestras descartadas.
+// La MAD se acota abajo a min_mad (la resolución del dato): con más de la
+// mitad de la ventana en el mismo valor la MAD es 0 y, sin piso, se
+// descartaría toda muestra distinta de la mediana.
+float robust_hampel_mean(float *v, float *scratch, size_t n, float k, float min_mad,
+                         size_t *rejected);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,126 @@
+#include "sample_ring.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+// Cada slot guarda el índice absoluto + 1 de la muestra que contiene
+// (0 = escribiéndose). El lector copia y vuelve a comparar seq: si cambió,
+// el productor lo sobrescribió durante la copia (seqlock).
+typedef struct {
+    atomic_uint_least32_t seq;
+    sample_t s;
+} ring_slot_t;
+
+#define RING_MASK (SAMPLE_RING_LEN - 1)
+
+_Static_assert((SAMPLE_RING_LEN & RING_MASK) == 0, "SAMPLE_RING_LEN debe ser potencia de 2");
+
+static ring_slot_t s_ring[SAMPLE_RING_LEN];
+static atomic_uint_least32_t s_head;   // muestras publicadas
+static TaskHandle_t s_waiters[SAMPLE_RING_MAX_WAITERS];
+static atomic_int s_n_waiters;
+
+void sample_ring_push(const sample_t *s)
+{
+    uint32_t idx = atomic_load_explicit(&s_head, memory_order_relaxed);
+    ring_slot_t *slot = &s_ring[idx & RING_MASK];
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->s = *s;
+    atomic_store_explicit(&slot->seq, idx + 1, memory_order_release);
+    atomic_store_explicit(&s_head, idx + 1, memory_order_release);
+
+    int n = atomic_load_explicit(&s_n_waiters, memory_order_acquire);
+    for (int i = 0; i < n; ++i) {
+        xTaskNotifyGive(s_waiters[i]);
+    }
+}
+
+bool sample_ring_subscribe(TaskHandle_t task)
+{
+    int n = atomic_load(&s_n_waiters);
+    if (!task || n >= SAMPLE_RING_MAX_WAITERS) {
+        return false;
+    }
+    s_waiters[n] = task;
+    atomic_store_explicit(&s_n_waiters, n + 1, memory_order_release);
+    return true;
+}
+
+static uint32_t ring_oldest(uint32_t head)
+{
+    return head > SAMPLE_RING_LEN ? head - SAMPLE_RING_LEN : 0;
+}
+
+void sample_ring_reader_init(sample_ring_reader_t *r, bool from_oldest)
+{
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+    r->next = from_oldest ? ring_oldest(head) : head;
+    r->overruns = 0;
+}
+
+// Copia la muestra idx si sigue en el buffer
+static bool ring_copy(uint32_t idx, sample_t *out)
+{
+    const ring_slot_t *slot = &s_ring[idx & RING_MASK];
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != idx + 1) {
+        return false;
+    }
+    *out = slot->s;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == idx + 1;
+}
+
+bool sample_ring_read(sample_ring_reader_t *r, sample_t *out)
+{
+    for (;;) {
+        uint32_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+        if (r->next == head) {
+            return false;
+        }
+        uint32_t oldest = ring_oldest(head);
+        if (r->next < oldest) {
+            r->overruns += oldest - r->next;
+            r->next = oldest;
+        }
+        if (ring_copy(r->next, out)) {
+            r->next++;
+            return true;
+        }
+        // Sobrescrita durante la copia: se perdió, seguir con la siguiente
+        r->overruns++;
+        r->next++;
+    }
+}
+
+bool sample_ring_get(uint32_t idx, sample_t *out)
+{
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+    if (idx >= head || idx < ring_oldest(head)) {
+        return false;
+    }
+    return ring_copy(idx, out);
+}
+
+size_t sample_ring_snapshot(sample_t *out, size_t max)
+{
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+    uint32_t first = ring_oldest(head);
+    if (head - first > max) {
+        first = head - (uint32_t)max;
+    }
+
+    size_t n = 0;
+    for (uint32_t idx = first; idx < head; ++idx) {
+        if (ring_copy(idx, &out[n])) {
+            n++;
+        }
+    }
+    return n;
+}
+
+uint32_t sample_ring_count(void)
+{
+    return atomic_load_explicit(&s_head, memory_order_acquire);
+}
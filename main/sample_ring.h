@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sensors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Buffer circular sin locks entre la tarea de adquisición (único productor)
+// y los consumidores (agregación de ventanas, alertas, captura...). El
+// productor nunca se bloquea: conserva las últimas SAMPLE_RING_LEN muestras y
+// sobrescribe la más vieja. Cada consumidor lleva su propio cursor; si se
+// atrasa más que el largo del buffer, salta a la más vieja disponible y
+// cuenta las muestras perdidas como overrun.
+
+#define SAMPLE_RING_LEN          64   // potencia de 2; > una ventana de 60
+#define SAMPLE_RING_MAX_WAITERS  3
+
+#define SAMPLE_FLAG_SCD_OK  0x01
+#define SAMPLE_FLAG_SEN_OK  0x02
+
+typedef struct {
+    SensorData data;
+    int64_t    t_us;        // esp_timer al tomar la muestra
+    time_t     epoch;
+    uint32_t   slot;        // índice de slot del planificador
+    int16_t    jitter_ms;   // muestra - deadline del slot
+    uint8_t    flags;       // SAMPLE_FLAG_*
+} sample_t;
+
+typedef struct {
+    uint32_t next;          // índice absoluto de la próxima muestra a leer
+    uint32_t overruns;      // muestras sobrescritas antes de leerlas
+} sample_ring_reader_t;
+
+// Productor (una sola tarea). Despierta a las tareas suscritas.
+void sample_ring_push(const sample_t *s);
+
+// Registra una tarea que recibe xTaskNotifyGive en cada push.
+bool sample_ring_subscribe(TaskHandle_t task);
+
+// Cursor nuevo: from_oldest = desde la muestra más vieja retenida;
+// si no, solo las que lleguen a partir de ahora.
+void sample_ring_reader_init(sample_ring_reader_t *r, bool from_oldest);
+
+// Copia la próxima muestra sin bloquear. false si no hay nuevas.
+bool sample_ring_read(sample_ring_reader_t *r, sample_t *out);
+
+// Copia la muestra de índice absoluto idx (el de sample_ring_read es
+// r->next - 1) si sigue retenida. Sirve para re-leer una ventana ya leída.
+bool sample_ring_get(uint32_t idx, sample_t *out);
+
+// Copia hasta max muestras retenidas (la más vieja primero) para
+// inspección o re-agregación. Devuelve cuántas copió.
+size_t sample_ring_snapshot(sample_t *out, size_t max);
+
+// Total de muestras publicadas desde el arranque.
+uint32_t sample_ring_count(void);
+
+#ifdef __cplusplus
+}
+#endif
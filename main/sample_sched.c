@@ -0,0 +1,45 @@
+#include "sample_sched.h"
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+static int64_t sched_deadline_us(const sample_sched_t *s, uint32_t slot)
+{
+    return s->t0_us + (int64_t)slot * s->period_us;
+}
+
+void sample_sched_init(sample_sched_t *s, uint32_t period_ms)
+{
+    memset(s, 0, sizeof(*s));
+    s->period_us = (int64_t)period_ms * 1000;
+    s->t0_us = esp_timer_get_time();
+}
+
+uint32_t sample_sched_wait(sample_sched_t *s)
+{
+    uint32_t slot = s->next_slot;
+    int64_t now = esp_timer_get_time();
+
+    if (now > sched_deadline_us(s, slot) + s->period_us / 2) {
+        uint32_t next = (uint32_t)((now - s->t0_us) / s->period_us) + 1;
+        s->missed += next - slot;
+        slot = next;
+    }
+
+    int64_t deadline = sched_deadline_us(s, slot);
+    while ((now = esp_timer_get_time()) < deadline) {
+        TickType_t ticks = pdMS_TO_TICKS((deadline - now + 999) / 1000);
+        vTaskDelay(ticks > 0 ? ticks : 1);
+    }
+
+    s->next_slot = slot + 1;
+    return slot;
+}
+
+int32_t sample_sched_jitter_ms(const sample_sched_t *s, uint32_t slot)
+{
+    return (int32_t)((esp_timer_get_time() - sched_deadline_us(s, slot)) / 1000);
+}
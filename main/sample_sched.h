@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Planificador de muestreo sin deriva: los instantes de muestra son
+// t0 + k * periodo (esp_timer), independientes de cuánto tarde cada lectura.
+// Si una lectura se atrasa más de medio periodo se saltan los slots vencidos
+// (se cuentan como perdidos) en vez de leer en ráfaga para ponerse al día.
+
+typedef struct {
+    int64_t  t0_us;
+    int64_t  period_us;
+    uint32_t next_slot;
+    uint32_t missed;         // slots saltados por atraso desde el arranque
+} sample_sched_t;
+
+// El slot 0 vence ahora; los siguientes cada period_ms.
+void sample_sched_init(sample_sched_t *s, uint32_t period_ms);
+
+// Duerme hasta el deadline del próximo slot y devuelve su índice.
+uint32_t sample_sched_wait(sample_sched_t *s);
+
+// Jitter en ms de una muestra del slot tomada ahora (ahora - deadline).
+int32_t sample_sched_jitter_ms(const sample_sched_t *s, uint32_t slot);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,388 @@
+#include "sensor_driver.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include <stdbool.h>
+
+#define SCD4X_ADDR              0x62
+#define SCD4X_I2C_FREQ_HZ       400000  // SCD4x: modo rápido
+
+#define SCD40_CO2_OUTPUT_MIN    1
+#define SCD40_CO2_OUTPUT_MAX    40000
+#define SCD40_CO2_SPEC_MIN      400
+#define SCD40_CO2_SPEC_MAX      2000
+
+#define SCD40_READY_POLL_MS     100
+#define SCD40_STOP_DELAY_MS     500     // stop_periodic_measurement
+#define SCD40_REINIT_DELAY_MS   30      // reinit
+#define SCD40_PERIODIC_MS       5000
+#define SCD40_LOW_POWER_MS      30000
+#define SCD40_SINGLE_SHOT_MS    5000
+#define SCD40_LOW_POWER_MIN_PERIOD_MS   30000
+#define SCD40_SINGLE_SHOT_MIN_PERIOD_MS 60000
+
+// Tiempo de ejecución entre comando y lectura (datasheet)
+#define SCD4X_CMD_EXEC_MS       1
+
+#define SCD4X_CMD_READ_MEASUREMENT   0xEC05
+#define SCD4X_CMD_GET_DATA_READY     0xE4B8
+
+static const char *TAG_SENS = "SCD4X";
+
+static i2c_master_dev_handle_t s_scd4x_dev = NULL;
+static int s_last_scd40_diag = SENSOR_DIAG_OK;
+
+// init arranca el SCD40 en periódico
+static scd40_mode_t s_scd40_mode = SCD40_MODE_PERIODIC;
+static bool s_scd40_started;        // ya se intentó el init de arranque
+
+// Buffer de la lectura en lote (begin -> decode)
+static uint8_t s_batch_buf[9];
+
+// ---------- SCD4x low level ----------
+static esp_err_t scd4x_start_measurement(void) {
+    uint8_t cmd[2] = {0x21, 0xB1};
+    return i2c_master_transmit(s_scd4x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+}
+
+static esp_err_t scd4x_start_low_power_measurement(void) {
+    uint8_t cmd[2] = {0x21, 0xAC};
+    return i2c_master_transmit(s_scd4x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+}
+
+static esp_err_t scd4x_stop_measurement(void) {
+    uint8_t cmd[2] = {0x3F, 0x86};
+    esp_err_t ret = i2c_master_transmit(s_scd4x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+    vTaskDelay(pdMS_TO_TICKS(SCD40_STOP_DELAY_MS));
+    return ret;
+}
+
+// Recarga la configuración de EEPROM; solo en reposo
+static esp_err_t scd4x_reinit(void) {
+    uint8_t cmd[2] = {0x36, 0x46};
+    esp_err_t ret = i2c_master_transmit(s_scd4x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+    vTaskDelay(pdMS_TO_TICKS(SCD40_REINIT_DELAY_MS));
+    return ret;
+}
+
+// Solo SCD41/43: el SCD40 no reconoce el comando y responde NACK
+static esp_err_t scd4x_measure_single_shot(void) {
+    uint8_t cmd[2] = {0x21, 0x9D};
+    return i2c_master_transmit(s_scd4x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+}
+
+static void scd4x_txn(i2c_txn_t *t, uint16_t cmd, uint8_t *rx, size_t rx_len) {
+    i2c_txn_init(t, s_scd4x_dev, SCD4X_ADDR, cmd, SCD4X_CMD_EXEC_MS, rx, rx_len);
+}
+
+// Diagnóstico del SCD40 a partir del resultado de una transacción
+static esp_err_t scd4x_txn_result(const i2c_txn_t *t) {
+    if (t->err != ESP_OK) {
+        s_last_scd40_diag = sensor_map_i2c_err(t->err, t->rx_stage);
+    }
+    return t->err;
+}
+
+static esp_err_t scd4x_decode_measurement(const uint8_t *data, uint16_t *co2, float *temperature, float *humidity) {
+    uint16_t words[3];
+    if (sensirion_check_words(data, 3, words) >= 0) {
+        ESP_LOGW(TAG_SENS, "SCD40 CRC inválido");
+        s_last_scd40_diag = SENSOR_DIAG_CRC;
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    *co2 = words[0];
+    if (*co2 < SCD40_CO2_OUTPUT_MIN || *co2 > SCD40_CO2_OUTPUT_MAX) {
+        ESP_LOGW(TAG_SENS, "SCD40 CO2 fuera de rango físico: %u ppm", *co2);
+        s_last_scd40_diag = SENSOR_DIAG_OUT_OF_RANGE;
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    if (*co2 < SCD40_CO2_SPEC_MIN || *co2 > SCD40_CO2_SPEC_MAX) {
+        ESP_LOGW(TAG_SENS,
+                 "SCD40 CO2 fuera del rango especificado de mejor precision (%u..%u ppm): %u ppm",
+                 SCD40_CO2_SPEC_MIN,
+                 SCD40_CO2_SPEC_MAX,
+                 *co2);
+    }
+
+    uint16_t raw_temp = words[1];
+    uint16_t raw_hum  = words[2];
+
+    *temperature = -45.0f + 175.0f * ((float)raw_temp / 65535.0f);
+    *humidity    = 100.0f * ((float)raw_hum / 65535.0f);
+
+    s_last_scd40_diag = SENSOR_DIAG_OK;
+    return ESP_OK;
+}
+
+static esp_err_t scd4x_read_measurement(uint16_t *co2, float *temperature, float *humidity) {
+    s_last_scd40_diag = SENSOR_DIAG_OK;
+
+    uint8_t data[9];
+    i2c_txn_t t;
+    scd4x_txn(&t, SCD4X_CMD_READ_MEASUREMENT, data, sizeof(data));
+    i2c_sched_run(&t, 1);
+    if (scd4x_txn_result(&t) != ESP_OK) {
+        return t.err;
+    }
+    return scd4x_decode_measurement(data, co2, temperature, humidity);
+}
+
+// get_data_ready_status: 11 bits bajos en 0 = todavía no hay medición nueva
+static esp_err_t scd4x_get_data_ready(bool *ready) {
+    uint8_t resp[3];
+    i2c_txn_t t;
+    scd4x_txn(&t, SCD4X_CMD_GET_DATA_READY, resp, sizeof(resp));
+    i2c_sched_run(&t, 1);
+    if (scd4x_txn_result(&t) != ESP_OK) {
+        return t.err;
+    }
+
+    if (sensirion_crc8_word(resp) != resp[2]) {
+        s_last_scd40_diag = SENSOR_DIAG_CRC;
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    uint16_t status = ((uint16_t)resp[0] << 8) | resp[1];
+    *ready = (status & 0x07FF) != 0;
+    return ESP_OK;
+}
+
+// Guardar siempre lo que haya llegado, aunque el valor quede fuera de rango
+static void scd4x_store(SensorData *out, uint16_t co2, float temp, float hum) {
+    out->co2 = co2;
+    out->scd_temp = temp;
+    out->scd_hum = hum;
+}
+
+// ---------- API ----------
+int sensors_get_last_scd40_diag(void) {
+    return s_last_scd40_diag;
+}
+
+esp_err_t sensors_read_scd40(SensorData *out) {
+    if (!out) return ESP_ERR_INVALID_ARG;
+
+    uint16_t co2 = 0;
+    float temp = 0.0f, hum = 0.0f;
+
+    esp_err_t ret = scd4x_read_measurement(&co2, &temp, &hum);
+    scd4x_store(out, co2, temp, hum);
+    return ret;
+}
+
+esp_err_t sensors_scd40_wait_ready(int timeout_ms) {
+    s_last_scd40_diag = SENSOR_DIAG_OK;
+
+    for (int waited = 0;; waited += SCD40_READY_POLL_MS) {
+        bool ready = false;
+        esp_err_t ret = scd4x_get_data_ready(&ready);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (ready) {
+            return ESP_OK;
+        }
+        if (waited >= timeout_ms) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(SCD40_READY_POLL_MS));
+    }
+
+    s_last_scd40_diag = SENSOR_DIAG_TIMEOUT;
+    return ESP_ERR_TIMEOUT;
+}
+
+scd40_mode_t sensors_scd40_mode_for_period(int period_ms) {
+    if (period_ms >= SCD40_SINGLE_SHOT_MIN_PERIOD_MS) return SCD40_MODE_SINGLE_SHOT;
+    if (period_ms >= SCD40_LOW_POWER_MIN_PERIOD_MS) return SCD40_MODE_LOW_POWER;
+    return SCD40_MODE_PERIODIC;
+}
+
+scd40_mode_t sensors_scd40_get_mode(void) {
+    return s_scd40_mode;
+}
+
+int sensors_scd40_interval_ms(void) {
+    switch (s_scd40_mode) {
+    case SCD40_MODE_LOW_POWER:   return SCD40_LOW_POWER_MS;
+    case SCD40_MODE_SINGLE_SHOT: return SCD40_SINGLE_SHOT_MS;
+    case SCD40_MODE_PERIODIC:
+    default:                     return SCD40_PERIODIC_MS;
+    }
+}
+
+esp_err_t sensors_scd40_set_mode(scd40_mode_t mode) {
+    if (!s_scd4x_dev) {
+        // Fuera del bus: el re-agregado (scd4x_restart) arranca este modo
+        s_scd40_mode = mode;
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (mode == s_scd40_mode) return ESP_OK;
+
+    // Los comandos de configuración y single-shot solo se aceptan en reposo
+    if (s_scd40_mode != SCD40_MODE_SINGLE_SHOT) {
+        scd4x_stop_measurement();
+    }
+
+    esp_err_t ret;
+    if (mode == SCD40_MODE_SINGLE_SHOT) {
+        ret = scd4x_measure_single_shot();
+        if (ret == ESP_OK) {
+            // La primera medición tras salir de reposo se descarta (datasheet)
+            s_scd40_mode = SCD40_MODE_SINGLE_SHOT;
+            uint16_t co2;
+            float temp, hum;
+            if (sensors_scd40_wait_ready(SCD40_SINGLE_SHOT_MS + 1000) == ESP_OK) {
+                scd4x_read_measurement(&co2, &temp, &hum);
+            }
+            ESP_LOGI(TAG_SENS, "SCD40 en modo single-shot");
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG_SENS, "SCD4x sin single-shot (%s); se usa bajo consumo",
+                 esp_err_to_name(ret));
+        mode = SCD40_MODE_LOW_POWER;
+    }
+
+    ret = mode == SCD40_MODE_LOW_POWER ? scd4x_start_low_power_measurement()
+                                       : scd4x_start_measurement();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_SENS, "No se pudo arrancar la medición del SCD40: %s",
+                 esp_err_to_name(ret));
+        return ret;
+    }
+    s_scd40_mode = mode;
+    ESP_LOGI(TAG_SENS, "SCD40 en modo %s",
+             mode == SCD40_MODE_LOW_POWER ? "bajo consumo (30 s)" : "periódico (5 s)");
+    return ESP_OK;
+}
+
+esp_err_t sensors_scd40_trigger(void) {
+    if (s_scd40_mode != SCD40_MODE_SINGLE_SHOT) return ESP_OK;
+
+    esp_err_t ret = scd4x_measure_single_shot();
+    if (ret != ESP_OK) {
+        s_last_scd40_diag = sensor_map_i2c_err(ret, false);
+    }
+    return ret;
+}
+
+// Re-agregado (sensor_health): vuelve a arrancar el modo que tenía sin
+// esperas fijas, que frenarían la tarea de sensores (y al SEN5x) varios
+// segundos. La primera lectura la regulan data-ready y el backoff.
+static esp_err_t scd4x_restart(scd40_mode_t mode) {
+    esp_err_t ret = ESP_OK;
+    if (mode == SCD40_MODE_PERIODIC) {
+        ret = scd4x_start_measurement();
+    } else if (mode == SCD40_MODE_LOW_POWER) {
+        ret = scd4x_start_low_power_measurement();
+    }
+    // Un start rechazado es un sensor que nunca dejó de medir: ya respondió
+    // al sondeo, así que sigue en su modo
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG_SENS, "SCD40 re-agregado: start rechazado (%s), se asume midiendo",
+                 esp_err_to_name(ret));
+    }
+    s_scd40_mode = mode;
+    s_last_scd40_diag = SENSOR_DIAG_OK;
+    return ESP_OK;
+}
+
+// ---------- Driver ----------
+static esp_err_t scd4x_init(i2c_master_bus_handle_t bus) {
+    // Al re-agregarlo (sensor_health) vuelve al modo que tenía
+    scd40_mode_t mode = s_scd40_mode;
+    // Si el de arranque falló, el que lo reintenta tampoco bloquea: scd4x_restart
+    // tolera un sensor que ya venía midiendo
+    bool restart = s_scd40_started;
+    s_scd40_started = true;
+
+    esp_err_t ret = sensor_add_device(bus, SCD4X_ADDR, SCD4X_I2C_FREQ_HZ, &s_scd4x_dev);
+    if (ret != ESP_OK) return ret;
+    if (restart) {
+        return scd4x_restart(mode);
+    }
+
+    // Si el ESP se reinició sin cortar la alimentación el sensor sigue
+    // midiendo y no aceptaría el start
+    scd4x_stop_measurement();
+    scd4x_start_measurement();
+    s_scd40_mode = SCD40_MODE_PERIODIC;
+    // Primera medición periódica
+    vTaskDelay(pdMS_TO_TICKS(SCD40_PERIODIC_MS));
+    s_last_scd40_diag = SENSOR_DIAG_OK;
+    if (mode != SCD40_MODE_PERIODIC) {
+        return sensors_scd40_set_mode(mode);
+    }
+    return ESP_OK;
+}
+
+// Reset suave: detiene la medición, recarga la configuración (reinit) y
+// vuelve a arrancar el modo activo
+static esp_err_t scd4x_reset(void) {
+    scd40_mode_t mode = s_scd40_mode;
+
+    // Sin respuesta al stop el reinit dirá si sigue colgado
+    scd4x_stop_measurement();
+    esp_err_t ret = scd4x_reinit();
+    if (ret != ESP_OK) return ret;
+
+    // En reposo, para set_mode, equivale a single-shot: no vuelve a detener
+    s_scd40_mode = SCD40_MODE_SINGLE_SHOT;
+    return sensors_scd40_set_mode(mode);
+}
+
+static void scd4x_release(void) {
+    if (s_scd4x_dev) {
+        i2c_master_bus_rm_device(s_scd4x_dev);
+        s_scd4x_dev = NULL;
+    }
+}
+
+static size_t scd4x_begin(i2c_txn_t *txns, size_t max) {
+    if (max < 1) return 0;
+    s_last_scd40_diag = SENSOR_DIAG_OK;
+    scd4x_txn(&txns[0], SCD4X_CMD_READ_MEASUREMENT, s_batch_buf, sizeof(s_batch_buf));
+    return 1;
+}
+
+static esp_err_t scd4x_decode(const i2c_txn_t *txns, size_t n, SensorData *out) {
+    if (n < 1) return ESP_ERR_INVALID_SIZE;
+
+    uint16_t co2 = 0;
+    float temp = 0.0f, hum = 0.0f;
+    esp_err_t ret = scd4x_txn_result(&txns[0]);
+    if (ret == ESP_OK) {
+        ret = scd4x_decode_measurement(s_batch_buf, &co2, &temp, &hum);
+    }
+    scd4x_store(out, co2, temp, hum);
+    return ret;
+}
+
+static bool scd4x_on_demand(void) {
+    return s_scd40_mode == SCD40_MODE_SINGLE_SHOT;
+}
+
+static const sensor_field_t s_scd4x_fields[] = {
+    SENSOR_FIELD_CO2,
+};
+
+const sensor_driver_t g_scd4x_driver = {
+    .name       = "SCD4x",
+    .src        = SENSOR_FIELD_SRC_SCD,
+    .fields     = s_scd4x_fields,
+    .n_fields   = sizeof(s_scd4x_fields) / sizeof(s_scd4x_fields[0]),
+    .init       = scd4x_init,
+    .period_ms  = sensors_scd40_interval_ms,
+    .begin      = scd4x_begin,
+    .decode     = scd4x_decode,
+    .read       = sensors_read_scd40,
+    .diag       = sensors_get_last_scd40_diag,
+    .wait_ready = sensors_scd40_wait_ready,
+    .on_demand  = scd4x_on_demand,
+    .trigger    = sensors_scd40_trigger,
+    .reset      = scd4x_reset,
+    .release    = scd4x_release,
+};
@@ -0,0 +1,255 @@
+#include "sensor_driver.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include <stdbool.h>
+
+#define SEN5X_ADDR              0x69
+#define SEN5X_I2C_FREQ_HZ       100000  // SEN5x: máximo 100 kHz
+
+#define SEN55_PERIOD_MS         1000
+#define SEN55_READY_POLLS       30
+#define SEN55_READY_DELAY_MS    20
+
+// Tiempo de ejecución entre comando y lectura (datasheet)
+#define SEN5X_CMD_EXEC_MS       20
+
+#define SEN5X_CMD_READ_DATA_READY    0x0202
+#define SEN5X_CMD_READ_VALUES        0x03C4
+#define SEN5X_VALUES_LEN             24
+
+static i2c_master_dev_handle_t s_sen5x_dev = NULL;
+static int s_last_sen55_diag = SENSOR_DIAG_OK;
+
+// Buffers de la lectura en lote (begin -> decode)
+static uint8_t s_batch_ready[3];
+static uint8_t s_batch_values[SEN5X_VALUES_LEN];
+
+// ---------- SEN5x low level ----------
+static esp_err_t sen5x_device_reset(void) {
+    uint8_t cmd[2] = {0xD3, 0x04};
+    return i2c_master_transmit(s_sen5x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+}
+
+static esp_err_t sen5x_start_measurement(void) {
+    uint8_t cmd[2] = {0x00, 0x21};
+    return i2c_master_transmit(s_sen5x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+}
+
+static void sen5x_txn(i2c_txn_t *t, uint16_t cmd, uint8_t *rx, size_t rx_len) {
+    i2c_txn_init(t, s_sen5x_dev, SEN5X_ADDR, cmd, SEN5X_CMD_EXEC_MS, rx, rx_len);
+}
+
+static esp_err_t sen5x_txn_result(const i2c_txn_t *t) {
+    if (t->err != ESP_OK) {
+        s_last_sen55_diag = sensor_map_i2c_err(t->err, t->rx_stage);
+    }
+    return t->err;
+}
+
+static esp_err_t sen5x_decode_data_ready(const uint8_t *resp, uint8_t *data_ready) {
+    if (sensirion_crc8_word(resp) != resp[2]) {
+        s_last_sen55_diag = SENSOR_DIAG_CRC;
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    *data_ready = resp[1];
+    return ESP_OK;
+}
+
+static esp_err_t sen5x_read_data_ready(uint8_t *data_ready) {
+    uint8_t resp[3];
+    i2c_txn_t t;
+    sen5x_txn(&t, SEN5X_CMD_READ_DATA_READY, resp, sizeof(resp));
+    i2c_sched_run(&t, 1);
+    if (sen5x_txn_result(&t) != ESP_OK) {
+        return t.err;
+    }
+    return sen5x_decode_data_ready(resp, data_ready);
+}
+
+static esp_err_t sen5x_read_measured_values(uint8_t *buf, int buflen) {
+    i2c_txn_t t;
+    sen5x_txn(&t, SEN5X_CMD_READ_VALUES, buf, (size_t)buflen);
+    i2c_sched_run(&t, 1);
+    return sen5x_txn_result(&t);
+}
+
+static int sen5x_decode_measurement(const uint8_t *buf,
+                                    float *pm1,
+                                    float *pm25,
+                                    float *pm4,
+                                    float *pm10,
+                                    float *rh,
+                                    float *temp,
+                                    float *voc_index,
+                                    float *nox_index) {
+    uint16_t values[8];
+
+    if (sensirion_check_words(buf, 8, values) >= 0) {
+        s_last_sen55_diag = SENSOR_DIAG_CRC;
+        return 0;
+    }
+
+    *pm1       = values[0] / 10.0f;
+    *pm25      = values[1] / 10.0f;
+    *pm4       = values[2] / 10.0f;
+    *pm10      = values[3] / 10.0f;
+    *rh        = values[4] / 100.0f;
+    *temp      = values[5] / 200.0f;
+    *voc_index = values[6] / 10.0f;
+    *nox_index = values[7] / 10.0f;
+
+    return 1;
+}
+
+// Sondea read_data_ready hasta polls veces
+static esp_err_t sen5x_wait_ready(int polls) {
+    for (int i = 0; i < polls; ++i) {
+        uint8_t data_ready = 0;
+        esp_err_t ret = sen5x_read_data_ready(&data_ready);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+
+        if (data_ready == 1) {
+            return ESP_OK;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(SEN55_READY_DELAY_MS));
+    }
+
+    s_last_sen55_diag = SENSOR_DIAG_TIMEOUT;
+    return ESP_ERR_TIMEOUT;
+}
+
+// Decodifica read_measured_values y completa out. Los promedios con el
+// SCD40 (avg_temp/avg_hum) los calcula sensors.c con ambos leídos.
+static esp_err_t sen5x_store(const uint8_t *buf, SensorData *out) {
+    float pm1, pm25, pm4, pm10, rh, temp, voc, nox;
+    if (!sen5x_decode_measurement(buf, &pm1, &pm25, &pm4, &pm10, &rh, &temp, &voc, &nox)) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    out->pm1p0 = pm1;
+    out->pm2p5 = pm25;
+    out->pm4p0 = pm4;
+    out->pm10p0 = pm10;
+    out->voc = voc;
+    out->nox = nox;
+    out->sen_temp = temp;
+    out->sen_hum = rh;
+
+    s_last_sen55_diag = SENSOR_DIAG_OK;
+    return ESP_OK;
+}
+
+// ---------- API ----------
+int sensors_get_last_sen55_diag(void) {
+    return s_last_sen55_diag;
+}
+
+esp_err_t sensors_read_sen55(SensorData *out) {
+    if (!out) return ESP_ERR_INVALID_ARG;
+
+    s_last_sen55_diag = SENSOR_DIAG_OK;
+
+    esp_err_t ret = sen5x_wait_ready(SEN55_READY_POLLS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    uint8_t buf[SEN5X_VALUES_LEN];
+    ret = sen5x_read_measured_values(buf, sizeof(buf));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return sen5x_store(buf, out);
+}
+
+// ---------- Driver ----------
+static esp_err_t sen5x_init(i2c_master_bus_handle_t bus) {
+    esp_err_t ret = sensor_add_device(bus, SEN5X_ADDR, SEN5X_I2C_FREQ_HZ, &s_sen5x_dev);
+    if (ret != ESP_OK) return ret;
+
+    sen5x_device_reset();
+    vTaskDelay(pdMS_TO_TICKS(100));
+    sen5x_start_measurement();
+    vTaskDelay(pdMS_TO_TICKS(50));
+    s_last_sen55_diag = SENSOR_DIAG_OK;
+    return ESP_OK;
+}
+
+static esp_err_t sen5x_reset(void) {
+    esp_err_t ret = sen5x_device_reset();
+    vTaskDelay(pdMS_TO_TICKS(100));
+    if (ret == ESP_OK) {
+        ret = sen5x_start_measurement();
+    }
+    vTaskDelay(pdMS_TO_TICKS(50));
+    return ret;
+}
+
+static void sen5x_release(void) {
+    if (s_sen5x_dev) {
+        i2c_master_bus_rm_device(s_sen5x_dev);
+        s_sen5x_dev = NULL;
+    }
+}
+
+static int sen5x_period_ms(void) {
+    return SEN55_PERIOD_MS;
+}
+
+// data-ready y valores encadenados en el mismo lote: si el dato no estaba
+// listo, decode lo informa y sensors.c cae a la lectura con sondeo
+static size_t sen5x_begin(i2c_txn_t *txns, size_t max) {
+    if (max < 2) return 0;
+    s_last_sen55_diag = SENSOR_DIAG_OK;
+    sen5x_txn(&txns[0], SEN5X_CMD_READ_DATA_READY, s_batch_ready, sizeof(s_batch_ready));
+    sen5x_txn(&txns[1], SEN5X_CMD_READ_VALUES, s_batch_values, sizeof(s_batch_values));
+    return 2;
+}
+
+static esp_err_t sen5x_decode(const i2c_txn_t *txns, size_t n, SensorData *out) {
+    if (n < 2) return ESP_ERR_INVALID_SIZE;
+
+    uint8_t data_ready = 0;
+    esp_err_t ret = sen5x_txn_result(&txns[0]);
+    if (ret == ESP_OK) {
+        ret = sen5x_decode_data_ready(s_batch_ready, &data_ready);
+    }
+    if (ret != ESP_OK) return ret;
+    if (data_ready != 1) return ESP_ERR_NOT_FINISHED;
+
+    ret = sen5x_txn_result(&txns[1]);
+    if (ret != ESP_OK) return ret;
+    return sen5x_store(s_batch_values, out);
+}
+
+static const sensor_field_t s_sen5x_fields[] = {
+    SENSOR_FIELD_PM1P0,
+    SENSOR_FIELD_PM2P5,
+    SENSOR_FIELD_PM4P0,
+    SENSOR_FIELD_PM10P0,
+    SENSOR_FIELD_VOC,
+    SENSOR_FIELD_NOX,
+    SENSOR_FIELD_SEN_TEMP,
+    SENSOR_FIELD_SEN_HUM,
+};
+
+const sensor_driver_t g_sen5x_driver = {
+    .name      = "SEN5x",
+    .src       = SENSOR_FIELD_SRC_SEN,
+    .fields    = s_sen5x_fields,
+    .n_fields  = sizeof(s_sen5x_fields) / sizeof(s_sen5x_fields[0]),
+    .init      = sen5x_init,
+    .period_ms = sen5x_period_ms,
+    .begin     = sen5x_begin,
+    .decode    = sen5x_decode,
+    .read      = sensors_read_sen55,
+    .diag      = sensors_get_last_sen55_diag,
+    .reset     = sen5x_reset,
+    .release   = sen5x_release,
+};
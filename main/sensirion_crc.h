@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CRC8 de las tramas Sensirion (SCD4x, SEN5x): cada palabra de 16 bits va
+// seguida de su CRC. Polinomio 0x31, inicial 0xFF, sin reflexión.
+
+// CRC8 Sensirion de una palabra [MSB, LSB]
+uint8_t sensirion_crc8_word(const uint8_t *w);
+
+// Valida n_words tripletas [MSB, LSB, CRC] de una trama y, si out no es
+// NULL, extrae las palabras. Devuelve el índice de la primera palabra con
+// CRC inválido, o -1 si todas están bien.
+int sensirion_check_words(const uint8_t *frame, int n_words, uint16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/i2c_master.h"
+#include "esp_err.h"
+#include "i2c_sched.h"
+#include "sensirion_crc.h"
+#include "sensor_fields.h"
+#include "sensors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Interfaz de driver de sensor. Cada sensor vive en su propio archivo y
+// exporta un sensor_driver_t; sensors.c los recorre desde una tabla para
+// inicializar, esperar, leer y diagnosticar sin saber cuáles son. Agregar
+// un sensor = un archivo nuevo + su entrada en la tabla y sus campos en
+// sensor_fields.
+
+#define SENSOR_DRIVER_MAX_TXNS 4   // transacciones de begin() por driver
+
+typedef struct sensor_driver {
+    const char *name;
+    uint8_t     src;                  // SENSOR_FIELD_SRC_* (= SAMPLE_FLAG_*)
+    const sensor_field_t *fields;     // campos que aporta
+    uint8_t     n_fields;
+
+    // Detecta e inicializa el sensor. ESP_ERR_NOT_FOUND = no está en la placa.
+    esp_err_t (*init)(i2c_master_bus_handle_t bus);
+
+    // Cadencia nativa de medición (en modo a demanda, lo que tarda una)
+    int       (*period_ms)(void);
+
+    // Lectura en dos fases para que sensors.c junte a todos los sensores en
+    // un solo lote del bus: begin arma hasta SENSOR_DRIVER_MAX_TXNS
+    // transacciones (con buffers propios del driver) y decode las
+    // interpreta. decode devuelve ESP_ERR_NOT_FINISHED si el sensor aún no
+    // tenía dato nuevo; entonces se usa read.
+    size_t    (*begin)(i2c_txn_t *txns, size_t max);
+    esp_err_t (*decode)(const i2c_txn_t *txns, size_t n, SensorData *out);
+
+    // Lectura completa bloqueante (sondeos incluidos)
+    esp_err_t (*read)(SensorData *out);
+
+    int       (*diag)(void);          // sensor_diag_code_t del último intento
+
+    // Opcionales (NULL = no aplica)
+    esp_err_t (*wait_ready)(int timeout_ms);  // espera medición nueva
+    bool      (*on_demand)(void);             // mide solo al dispararlo
+    esp_err_t (*trigger)(void);
+
+    // Recuperación (sensor_health): reset suave por comando, sin tocar el
+    // bus, y quitar el dispositivo del bus para que init lo vuelva a agregar
+    esp_err_t (*reset)(void);
+    void      (*release)(void);
+} sensor_driver_t;
+
+extern const sensor_driver_t g_scd4x_driver;
+extern const sensor_driver_t g_sen5x_driver;
+
+// ---------- Helpers comunes (sensors.c) ----------
+int sensor_map_i2c_err(esp_err_t err, bool is_rx_stage);
+
+// Sondea addr y lo agrega al bus. ESP_ERR_NOT_FOUND si no responde (NACK);
+// un bus colgado da el error del sondeo (p.ej. ESP_ERR_TIMEOUT).
+esp_err_t sensor_add_device(i2c_master_bus_handle_t bus, uint16_t addr,
+                            uint32_t scl_speed_hz, i2c_master_dev_handle_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,53 @@
+#include "sensor_fields.h"
+
+#include <math.h>
+
+const sensor_field_desc_t g_sensor_fields[SENSOR_FIELD_COUNT] = {
+    [SENSOR_FIELD_PM1P0]    = { "pm1p0",          2, SENSOR_FIELD_SRC_SEN, 0.1f   },
+    [SENSOR_FIELD_PM2P5]    = { "pm2p5",          2, SENSOR_FIELD_SRC_SEN, 0.1f   },
+    [SENSOR_FIELD_PM4P0]    = { "pm4p0",          2, SENSOR_FIELD_SRC_SEN, 0.1f   },
+    [SENSOR_FIELD_PM10P0]   = { "pm10p0",         2, SENSOR_FIELD_SRC_SEN, 0.1f   },
+    [SENSOR_FIELD_VOC]      = { "voc",            1, SENSOR_FIELD_SRC_SEN, 0.1f   },
+    [SENSOR_FIELD_NOX]      = { "nox",            1, SENSOR_FIELD_SRC_SEN, 0.1f   },
+    [SENSOR_FIELD_CTE]      = { "cTe",            2, SENSOR_FIELD_SRC_SEN, 0.005f },
+    [SENSOR_FIELD_CHU]      = { "cHu",            2, SENSOR_FIELD_SRC_SEN, 0.01f  },
+    [SENSOR_FIELD_CO2]      = { "co2",            0, SENSOR_FIELD_SRC_SCD, 1.0f   },
+    [SENSOR_FIELD_SEN_TEMP] = { "sen55_temp_dbg", 2, SENSOR_FIELD_SRC_SEN, 0.005f },
+    [SENSOR_FIELD_SEN_HUM]  = { "sen55_hum_dbg",  2, SENSOR_FIELD_SRC_SEN, 0.01f  },
+};
+
+float sensor_field_get(const SensorData *d, sensor_field_t f)
+{
+    switch (f) {
+    case SENSOR_FIELD_PM1P0:    return d->pm1p0;
+    case SENSOR_FIELD_PM2P5:    return d->pm2p5;
+    case SENSOR_FIELD_PM4P0:    return d->pm4p0;
+    case SENSOR_FIELD_PM10P0:   return d->pm10p0;
+    case SENSOR_FIELD_VOC:      return d->voc;
+    case SENSOR_FIELD_NOX:      return d->nox;
+    case SENSOR_FIELD_CTE:      return d->avg_temp;
+    case SENSOR_FIELD_CHU:      return d->avg_hum;
+    case SENSOR_FIELD_CO2:      return (float)d->co2;
+    case SENSOR_FIELD_SEN_TEMP: return d->sen_temp;
+    case SENSOR_FIELD_SEN_HUM:  return d->sen_hum;
+    default:                    return 0.0f;
+    }
+}
+
+void sensor_field_set(SensorData *d, sensor_field_t f, float v)
+{
+    switch (f) {
+    case SENSOR_FIELD_PM1P0:    d->pm1p0 = v; break;
+    case SENSOR_FIELD_PM2P5:    d->pm2p5 = v; break;
+    case SENSOR_FIELD_PM4P0:    d->pm4p0 = v; break;
+    case SENSOR_FIELD_PM10P0:   d->pm10p0 = v; break;
+    case SENSOR_FIELD_VOC:      d->voc = v; break;
+    case SENSOR_FIELD_NOX:      d->nox = v; break;
+    case SENSOR_FIELD_CTE:      d->avg_temp = v; break;
+    case SENSOR_FIELD_CHU:      d->avg_hum = v; break;
+    case SENSOR_FIELD_CO2:      d->co2 = isnan(v) ? 0 : (uint16_t)lroundf(v); break;
+    case SENSOR_FIELD_SEN_TEMP: d->sen_temp = v; break;
+    case SENSOR_FIELD_SEN_HUM:  d->sen_hum = v; break;
+    default: break;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sensors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Campos de medición de una ventana, en el orden del JSON de ingest.
+typedef enum {
+    SENSOR_FIELD_PM1P0 = 0,
+    SENSOR_FIELD_PM2P5,
+    SENSOR_FIELD_PM4P0,
+    SENSOR_FIELD_PM10P0,
+    SENSOR_FIELD_VOC,
+    SENSOR_FIELD_NOX,
+    SENSOR_FIELD_CTE,        // avg_temp
+    SENSOR_FIELD_CHU,        // avg_hum
+    SENSOR_FIELD_CO2,
+    SENSOR_FIELD_SEN_TEMP,
+    SENSOR_FIELD_SEN_HUM,
+    SENSOR_FIELD_COUNT
+} sensor_field_t;
+
+// Sensor del que sale el campo (mismos bits que SAMPLE_FLAG_*)
+#define SENSOR_FIELD_SRC_SCD  0x01
+#define SENSOR_FIELD_SRC_SEN  0x02
+
+typedef struct {
+    const char *key;       // clave JSON
+    uint8_t     decimals;  // precisión del JSON
+    uint8_t     src;       // SENSOR_FIELD_SRC_*
+    float       resolution; // paso del dato crudo del sensor
+} sensor_field_desc_t;
+
+extern const sensor_field_desc_t g_sensor_fields[SENSOR_FIELD_COUNT];
+
+float sensor_field_get(const SensorData *d, sensor_field_t f);
+// CO2 es entero: NaN (sin dato) queda en 0
+void sensor_field_set(SensorData *d, sensor_field_t f, float v);
+
+#ifdef __cplusplus
+}
+#endif
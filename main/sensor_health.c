@@ -0,0 +1,132 @@
+#include "sensor_health.h"
+
+#include <stdio.h>
+
+#include "sensors.h"
+
+void sensor_health_init(sensor_health_t *h)
+{
+    *h = (sensor_health_t){ .state = SENSOR_HEALTH_OK };
+}
+
+bool sensor_health_active(const sensor_health_t *h, int64_t now_us)
+{
+    return now_us >= h->resume_us;
+}
+
+static void backoff_next(sensor_health_t *h, int64_t now_us)
+{
+    if (h->backoff_ms == 0) {
+        h->backoff_ms = SENSOR_HEALTH_BACKOFF_MIN_MS;
+    } else if (h->backoff_ms < SENSOR_HEALTH_BACKOFF_MAX_MS / 2) {
+        h->backoff_ms *= 2;
+    } else {
+        h->backoff_ms = SENSOR_HEALTH_BACKOFF_MAX_MS;
+    }
+    h->resume_us = now_us + (int64_t)h->backoff_ms * 1000;
+}
+
+void sensor_health_init_detached(sensor_health_t *h, int diag, int64_t now_us)
+{
+    sensor_health_init(h);
+    h->state = SENSOR_HEALTH_READD;
+    h->last_diag = (uint8_t)diag;
+    backoff_next(h, now_us);
+}
+
+static bool diag_escalates(int diag)
+{
+    switch (diag) {
+    case SENSOR_DIAG_CRC:
+    case SENSOR_DIAG_TIMEOUT:
+    case SENSOR_DIAG_I2C_TX:
+    case SENSOR_DIAG_I2C_RX:
+        return true;
+    default:
+        return false;
+    }
+}
+
+sensor_recover_t sensor_health_report(sensor_health_t *h, bool ok, int diag, int64_t now_us)
+{
+    if (ok) {
+        h->reads_ok++;
+        if (h->state > SENSOR_HEALTH_RETRY) {
+            h->recoveries++;
+        }
+        h->state = SENSOR_HEALTH_OK;
+        h->consecutive = 0;
+        h->backoff_ms = 0;
+        h->resume_us = 0;
+        return SENSOR_RECOVER_NONE;
+    }
+
+    h->reads_failed++;
+    h->last_diag = (uint8_t)diag;
+    if (!diag_escalates(diag)) {
+        return SENSOR_RECOVER_NONE;
+    }
+
+    if (h->state == SENSOR_HEALTH_OK) {
+        h->state = SENSOR_HEALTH_RETRY;
+    }
+    if (++h->consecutive < SENSOR_HEALTH_FAILS_PER_STEP) {
+        return SENSOR_RECOVER_NONE;
+    }
+
+    // Siguiente escalón; re-agregar es el último y se repite
+    h->consecutive = 0;
+    if (h->state < SENSOR_HEALTH_READD) {
+        h->state++;
+    }
+
+    backoff_next(h, now_us);
+
+    switch (h->state) {
+    case SENSOR_HEALTH_SOFT_RESET:
+        h->soft_resets++;
+        return SENSOR_RECOVER_SOFT_RESET;
+    case SENSOR_HEALTH_BUS_RECOVERY:
+        h->bus_recoveries++;
+        return SENSOR_RECOVER_BUS;
+    default:
+        h->readds++;
+        return SENSOR_RECOVER_READD;
+    }
+}
+
+void sensor_health_readd_attempt(sensor_health_t *h, int64_t now_us)
+{
+    h->state = SENSOR_HEALTH_READD;
+    h->consecutive = 0;
+    h->readds++;
+    backoff_next(h, now_us);
+}
+
+const char *sensor_health_state_name(sensor_health_state_t state)
+{
+    switch (state) {
+    case SENSOR_HEALTH_OK:           return "ok";
+    case SENSOR_HEALTH_RETRY:        return "retry";
+    case SENSOR_HEALTH_SOFT_RESET:   return "reset";
+    case SENSOR_HEALTH_BUS_RECOVERY: return "bus";
+    case SENSOR_HEALTH_READD:        return "readd";
+    default:                         return "?";
+    }
+}
+
+int sensor_health_format_json(const sensor_health_t *h, char *buf, size_t len)
+{
+    int n = snprintf(buf, len,
+                     "{\"st\":\"%s\",\"ok\":%u,\"fail\":%u,\"diag\":%u,"
+                     "\"sr\":%u,\"br\":%u,\"ra\":%u,\"rec\":%u}",
+                     sensor_health_state_name(h->state),
+                     (unsigned)h->reads_ok, (unsigned)h->reads_failed,
+                     (unsigned)h->last_diag, (unsigned)h->soft_resets,
+                     (unsigned)h->bus_recoveries, (unsigned)h->readds,
+                     (unsigned)h->recoveries);
+    if (n < 0 || (size_t)n >= len) {
+        return -1;
+    }
+    return n;
+}
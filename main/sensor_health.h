@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Salud por sensor: máquina de estados que escala con fallos consecutivos.
+// Cada SENSOR_HEALTH_FAILS_PER_STEP fallos seguidos se pasa al siguiente
+// escalón y se pide su acción de recuperación: reset suave del sensor,
+// recuperación del bus I2C y, por último, quitar y volver a agregar el
+// dispositivo (este último se repite mientras siga fallando). Tras cada
+// acción el sensor queda en pausa con backoff exponencial. Una lectura
+// buena vuelve todo a OK. Lógica pura: las acciones las ejecuta sensors.c.
+
+#define SENSOR_HEALTH_FAILS_PER_STEP  3
+#define SENSOR_HEALTH_BACKOFF_MIN_MS  10000
+#define SENSOR_HEALTH_BACKOFF_MAX_MS  (15 * 60 * 1000)
+
+typedef enum {
+    SENSOR_HEALTH_OK = 0,
+    SENSOR_HEALTH_RETRY,          // fallos sueltos: se reintenta en el próximo slot
+    SENSOR_HEALTH_SOFT_RESET,
+    SENSOR_HEALTH_BUS_RECOVERY,
+    SENSOR_HEALTH_READD,
+} sensor_health_state_t;
+
+typedef enum {
+    SENSOR_RECOVER_NONE = 0,
+    SENSOR_RECOVER_SOFT_RESET,
+    SENSOR_RECOVER_BUS,
+    SENSOR_RECOVER_READD,
+} sensor_recover_t;
+
+typedef struct {
+    sensor_health_state_t state;
+    uint8_t  last_diag;       // sensor_diag_code_t del último fallo
+    uint16_t consecutive;     // fallos seguidos en el escalón actual
+    uint32_t backoff_ms;      // pausa tras la última acción (0 = ninguna)
+    int64_t  resume_us;       // no leer antes de esto
+
+    // Contadores desde el arranque (telemetría)
+    uint32_t reads_ok;
+    uint32_t reads_failed;
+    uint32_t soft_resets;
+    uint32_t bus_recoveries;
+    uint32_t readds;
+    uint32_t recoveries;      // vueltas a OK después de un escalón
+} sensor_health_t;
+
+void sensor_health_init(sensor_health_t *h);
+
+// Sensor que no se pudo inicializar al arrancar por una falla (timeout,
+// I2C, CRC; no por ausencia): arranca fuera del bus en READD, con el primer
+// re-agregado al vencer el backoff mínimo.
+void sensor_health_init_detached(sensor_health_t *h, int diag, int64_t now_us);
+
+// false mientras dura el backoff de la última acción
+bool sensor_health_active(const sensor_health_t *h, int64_t now_us);
+
+// Registra el resultado de un intento (diag = sensor_diag_code_t) y
+// devuelve la acción de recuperación a ejecutar ahora, si corresponde.
+// Solo escalan los fallos de comunicación (timeout, I2C, CRC); un valor
+// fuera de rango se cuenta pero el sensor está respondiendo.
+sensor_recover_t sensor_health_report(sensor_health_t *h, bool ok, int diag, int64_t now_us);
+
+// Intento de re-agregar un sensor que quedó fuera del bus porque el
+// re-agregado anterior falló: lo cuenta y programa el siguiente backoff.
+void sensor_health_readd_attempt(sensor_health_t *h, int64_t now_us);
+
+const char *sensor_health_state_name(sensor_health_state_t state);
+
+// {"st":"retry","ok":N,"fail":N,"diag":N,"sr":N,"br":N,"ra":N,"rec":N}
+// Devuelve los bytes escritos o -1 si no entra.
+int sensor_health_format_json(const sensor_health_t *h, char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
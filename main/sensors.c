@@ -1,44 +1,49 @@
 #include "sensors.h"
+#include "payload_json.h"
+#include "sensor_driver.h"
+#include "sensor_health.h"
 #include "driver/i2c_master.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
-#include "Privado.h" // DEVICE_ID
 
 #include <stdbool.h>
 #include <stdio.h>
-#include <string.h>
 
 #define I2C_MASTER_SCL_IO       19
 #define I2C_MASTER_SDA_IO       18
-#define I2C_MASTER_FREQ_HZ      100000
 #define I2C_PORT                I2C_NUM_0
+#define I2C_PROBE_TIMEOUT_MS    50
 
-#define SCD4X_ADDR              0x62
-#define SEN5X_ADDR              0x69
-
-#define SCD40_CO2_OUTPUT_MIN    1
-#define SCD40_CO2_OUTPUT_MAX    40000
-#define SCD40_CO2_SPEC_MIN      400
-#define SCD40_CO2_SPEC_MAX      2000
-
-#define SEN55_READY_POLLS       30
-#define SEN55_READY_DELAY_MS    20
+#define SENSORS_MAX_TXNS        8
 
 static const char *TAG_SENS = "SENSORS";
-static char g_city_state[64] = "----";
 
-// --- I2C v2 bus/device handles ---
+// --- I2C v2 bus ---
 static i2c_master_bus_handle_t s_i2c_bus = NULL;
-static i2c_master_dev_handle_t s_scd4x_dev = NULL;
-static i2c_master_dev_handle_t s_sen5x_dev = NULL;
 
-// Último diagnóstico por sensor
-static int s_last_scd40_diag = SENSOR_DIAG_OK;
-static int s_last_sen55_diag = SENSOR_DIAG_OK;
+// Drivers registrados, en el orden en que se inicializan y leen
+static const sensor_driver_t *const s_drivers[] = {
+    &g_scd4x_driver,
+    &g_sen5x_driver,
+};
+#define SENSORS_N_DRIVERS (sizeof(s_drivers) / sizeof(s_drivers[0]))
+
+_Static_assert(SENSORS_N_DRIVERS * SENSOR_DRIVER_MAX_TXNS <= SENSORS_MAX_TXNS,
+               "SENSORS_MAX_TXNS chico para los drivers registrados");
+
+static uint8_t  s_present;          // bits src de los drivers detectados
+static uint32_t s_present_fields;   // bits (1 << sensor_field_t)
+
+// Recuperación de fallos (sensor_health.h), en el orden de s_drivers. La
+// escribe solo la tarea de sensores; upload_task lee los contadores (32
+// bits) para la telemetría sin lock.
+static sensor_health_t s_health[SENSORS_N_DRIVERS];
+static uint8_t s_detached;          // presentes cuyo re-agregado falló
 
 // ---------- Helpers de diagnóstico ----------
-static int map_i2c_err_to_diag(esp_err_t err, bool is_rx_stage) {
+int sensor_map_i2c_err(esp_err_t err, bool is_rx_stage) {
     if (err == ESP_OK) return SENSOR_DIAG_OK;
     if (err == ESP_ERR_INVALID_CRC) return SENSOR_DIAG_CRC;
     if (err == ESP_ERR_TIMEOUT) return SENSOR_DIAG_TIMEOUT;
@@ -46,176 +51,282 @@ static int map_i2c_err_to_diag(esp_err_t err, bool is_rx_stage) {
     return is_rx_stage ? SENSOR_DIAG_I2C_RX : SENSOR_DIAG_I2C_TX;
 }
 
-int sensors_get_last_scd40_diag(void) {
-    return s_last_scd40_diag;
-}
+esp_err_t sensor_add_device(i2c_master_bus_handle_t bus, uint16_t addr,
+                            uint32_t scl_speed_hz, i2c_master_dev_handle_t *out) {
+    // NACK = ESP_ERR_NOT_FOUND (ausente); un timeout es una falla del bus
+    esp_err_t ret = i2c_master_probe(bus, addr, I2C_PROBE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
-int sensors_get_last_sen55_diag(void) {
-    return s_last_sen55_diag;
+    i2c_device_config_t cfg = {
+        .device_address = addr,
+        .scl_speed_hz = scl_speed_hz,
+    };
+    return i2c_master_bus_add_device(bus, &cfg, out);
 }
 
-void sensors_reset_diag(void) {
-    s_last_scd40_diag = SENSOR_DIAG_OK;
-    s_last_sen55_diag = SENSOR_DIAG_OK;
+// ---------- Registro de drivers ----------
+static bool driver_present(const sensor_driver_t *drv) {
+    return (s_present & drv->src) != 0;
 }
 
-// ---------- CRC8 Sensirion ----------
-static uint8_t sensirion_crc8(const uint8_t *data, int len) {
-    uint8_t crc = 0xFF;
-    for (int i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (int b = 0; b < 8; b++) {
-            if (crc & 0x80) crc = (crc << 1) ^ 0x31;
-            else crc <<= 1;
-        }
+// Última lectura del SCD40 para cTe/cHu (solo la tarea de sensores)
+static float   s_scd_last_temp;
+static float   s_scd_last_hum;
+static int64_t s_scd_last_us;       // 0 = nunca leyó
+
+// Temperatura/humedad combinadas (cTe/cHu siguen al SEN55 en
+// g_sensor_fields): promedio del SEN55 con la última lectura del SCD40, así
+// la definición no depende de si el SCD40 tocaba en este slot cuando las
+// cadencias difieren. Solo SEN55 si el SCD40 no leyó en
+// SENSORS_DERIVE_MAX_AGE_MS (falla o ausente).
+static void sensors_derive(SensorData *d, uint8_t ok) {
+    int64_t now_us = esp_timer_get_time();
+    if (ok & SENSOR_FIELD_SRC_SCD) {
+        s_scd_last_temp = d->scd_temp;
+        s_scd_last_hum = d->scd_hum;
+        s_scd_last_us = now_us;
     }
-    return crc;
-}
+    if (!(ok & SENSOR_FIELD_SRC_SEN)) return;
 
-// ---------- SCD4x low level ----------
-static esp_err_t scd4x_start_measurement(void) {
-    uint8_t cmd[2] = {0x21, 0xB1};
-    return i2c_master_transmit(s_scd4x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+    if (s_scd_last_us && now_us - s_scd_last_us <= (int64_t)SENSORS_DERIVE_MAX_AGE_MS * 1000) {
+        d->avg_temp = (s_scd_last_temp + d->sen_temp) / 2.0f;
+        d->avg_hum  = (s_scd_last_hum + d->sen_hum) / 2.0f;
+    } else {
+        d->avg_temp = d->sen_temp;
+        d->avg_hum  = d->sen_hum;
+    }
 }
 
-static esp_err_t scd4x_read_measurement(uint16_t *co2, float *temperature, float *humidity) {
-    s_last_scd40_diag = SENSOR_DIAG_OK;
+// ---------- Recuperación de fallos ----------
+static esp_err_t sensor_readd(size_t i) {
+    const sensor_driver_t *drv = s_drivers[i];
+    if (drv->release) {
+        drv->release();
+    }
+    s_detached |= drv->src;
 
-    uint8_t cmd[2] = {0xEC, 0x05};
-    esp_err_t ret = i2c_master_transmit(s_scd4x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        s_last_scd40_diag = map_i2c_err_to_diag(ret, false);
-        return ret;
+    esp_err_t ret = drv->init(s_i2c_bus);
+    if (ret == ESP_OK) {
+        s_detached &= (uint8_t)~drv->src;
     }
+    return ret;
+}
 
-    vTaskDelay(pdMS_TO_TICKS(1));
+static void sensor_recover(size_t i, sensor_recover_t action) {
+    const sensor_driver_t *drv = s_drivers[i];
+    const sensor_health_t *h = &s_health[i];
+    esp_err_t ret;
 
-    uint8_t data[9];
-    ret = i2c_master_receive(s_scd4x_dev, data, sizeof(data), pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        s_last_scd40_diag = map_i2c_err_to_diag(ret, true);
-        return ret;
+    switch (action) {
+    case SENSOR_RECOVER_SOFT_RESET:
+        ret = drv->reset ? drv->reset() : ESP_ERR_NOT_SUPPORTED;
+        break;
+    case SENSOR_RECOVER_BUS:
+        // Saca a un esclavo que quedó reteniendo SDA (pulsos de SCL)
+        ret = i2c_master_bus_reset(s_i2c_bus);
+        break;
+    case SENSOR_RECOVER_READD:
+        ret = sensor_readd(i);
+        break;
+    default:
+        return;
     }
 
-    if (sensirion_crc8(&data[0], 2) != data[2] ||
-        sensirion_crc8(&data[3], 2) != data[5] ||
-        sensirion_crc8(&data[6], 2) != data[8]) {
-        ESP_LOGW(TAG_SENS, "SCD40 CRC inválido");
-        s_last_scd40_diag = SENSOR_DIAG_CRC;
-        return ESP_ERR_INVALID_CRC;
+    ESP_LOGW(TAG_SENS, "%s: %d fallos seguidos (diag=%02u) -> %s: %s; pausa %u s",
+             drv->name, SENSOR_HEALTH_FAILS_PER_STEP, (unsigned)h->last_diag,
+             sensor_health_state_name(h->state), esp_err_to_name(ret),
+             (unsigned)(h->backoff_ms / 1000));
+}
+
+// Resultado de un intento de lectura o espera del driver i
+static void sensor_report(size_t i, esp_err_t ret) {
+    const sensor_driver_t *drv = s_drivers[i];
+    int diag = drv->diag();
+    if (ret != ESP_OK && diag == SENSOR_DIAG_OK) {
+        diag = sensor_map_i2c_err(ret, false);
     }
 
-    *co2 = ((uint16_t)data[0] << 8) | data[1];
-    if (*co2 < SCD40_CO2_OUTPUT_MIN || *co2 > SCD40_CO2_OUTPUT_MAX) {
-        ESP_LOGW(TAG_SENS, "SCD40 CO2 fuera de rango físico: %u ppm", *co2);
-        s_last_scd40_diag = SENSOR_DIAG_OUT_OF_RANGE;
-        return ESP_ERR_INVALID_RESPONSE;
+    sensor_recover_t action = sensor_health_report(&s_health[i], ret == ESP_OK, diag,
+                                                   esp_timer_get_time());
+    if (action != SENSOR_RECOVER_NONE) {
+        sensor_recover(i, action);
     }
+}
 
-    if (*co2 < SCD40_CO2_SPEC_MIN || *co2 > SCD40_CO2_SPEC_MAX) {
-        ESP_LOGW(TAG_SENS,
-                 "SCD40 CO2 fuera del rango especificado de mejor precision (%u..%u ppm): %u ppm",
-                 SCD40_CO2_SPEC_MIN,
-                 SCD40_CO2_SPEC_MAX,
-                 *co2);
+// Sensores de mask que se pueden usar ahora: presentes, en el bus y fuera
+// del backoff. Los que quedaron fuera del bus se re-agregan al vencer su
+// backoff; si vuelve a fallar, el backoff crece.
+static uint8_t sensors_active(uint8_t mask) {
+    int64_t now_us = esp_timer_get_time();
+    uint8_t active = 0;
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        if (!driver_present(drv) || !(mask & drv->src)) continue;
+        if (!sensor_health_active(&s_health[i], now_us)) continue;
+
+        if (s_detached & drv->src) {
+            sensor_health_readd_attempt(&s_health[i], now_us);
+            esp_err_t ret = sensor_readd(i);
+            ESP_LOGW(TAG_SENS, "%s: re-agregado: %s", drv->name, esp_err_to_name(ret));
+            continue;   // se lee al terminar el backoff
+        }
+        active |= drv->src;
     }
+    return active;
+}
+
+int sensors_health_format_json(char *buf, size_t len) {
+    if (!buf || len < 3) return -1;
 
-    uint16_t raw_temp = ((uint16_t)data[3] << 8) | data[4];
-    uint16_t raw_hum  = ((uint16_t)data[6] << 8) | data[7];
+    size_t pos = 0;
+    buf[pos++] = '{';
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        if (!driver_present(drv)) continue;
 
-    *temperature = -45.0f + 175.0f * ((float)raw_temp / 65535.0f);
-    *humidity    = 100.0f * ((float)raw_hum / 65535.0f);
+        int n = snprintf(buf + pos, len - pos, "%s\"%s\":", pos > 1 ? "," : "", drv->name);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += (size_t)n;
 
-    s_last_scd40_diag = SENSOR_DIAG_OK;
-    return ESP_OK;
+        n = sensor_health_format_json(&s_health[i], buf + pos, len - pos);
+        if (n < 0) return -1;
+        pos += (size_t)n;
+    }
+    if (pos + 2 > len) return -1;
+    buf[pos++] = '}';
+    buf[pos] = '\0';
+    return (int)pos;
 }
 
-// ---------- SEN5x low level ----------
-static esp_err_t sen5x_device_reset(void) {
-    uint8_t cmd[2] = {0xD3, 0x04};
-    return i2c_master_transmit(s_sen5x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+void sensors_health_log(void) {
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        const sensor_health_t *h = &s_health[i];
+        if (!driver_present(drv)) continue;
+
+        ESP_LOGI(TAG_SENS,
+                 "%s salud=%s ok=%u fallos=%u diag=%02u reset=%u bus=%u readd=%u recuperado=%u",
+                 drv->name, sensor_health_state_name(h->state),
+                 (unsigned)h->reads_ok, (unsigned)h->reads_failed, (unsigned)h->last_diag,
+                 (unsigned)h->soft_resets, (unsigned)h->bus_recoveries,
+                 (unsigned)h->readds, (unsigned)h->recoveries);
+    }
 }
 
-static esp_err_t sen5x_start_measurement(void) {
-    uint8_t cmd[2] = {0x00, 0x21};
-    return i2c_master_transmit(s_sen5x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
+uint8_t sensors_present_mask(void) {
+    return s_present;
 }
 
-static esp_err_t sen5x_read_data_ready(uint8_t *data_ready) {
-    uint8_t cmd[2] = {0x02, 0x02};
-    esp_err_t ret = i2c_master_transmit(s_sen5x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        s_last_sen55_diag = map_i2c_err_to_diag(ret, false);
-        return ret;
-    }
+uint32_t sensors_present_fields(void) {
+    return s_present_fields;
+}
 
-    vTaskDelay(pdMS_TO_TICKS(20));
+size_t sensors_driver_count(void) {
+    return SENSORS_N_DRIVERS;
+}
 
-    uint8_t resp[3];
-    ret = i2c_master_receive(s_sen5x_dev, resp, sizeof(resp), pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        s_last_sen55_diag = map_i2c_err_to_diag(ret, true);
-        return ret;
-    }
+const sensor_driver_t *sensors_driver_get(size_t i) {
+    return i < SENSORS_N_DRIVERS ? s_drivers[i] : NULL;
+}
 
-    if (sensirion_crc8(resp, 2) != resp[2]) {
-        s_last_sen55_diag = SENSOR_DIAG_CRC;
-        return ESP_ERR_INVALID_CRC;
+esp_err_t sensors_align(int margin_ms) {
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        if (!driver_present(drv) || !drv->wait_ready) continue;
+        if ((s_detached & drv->src) || (drv->on_demand && drv->on_demand())) continue;
+        // El primero con data-ready periódico marca el ritmo
+        return drv->wait_ready(drv->period_ms() + margin_ms);
     }
+    return ESP_ERR_NOT_FOUND;
+}
 
-    *data_ready = resp[1];
-    return ESP_OK;
+bool sensors_on_demand(void) {
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        if (driver_present(drv) && drv->on_demand && drv->on_demand()) {
+            return true;
+        }
+    }
+    return false;
 }
 
-static esp_err_t sen5x_read_measured_values(uint8_t *buf, int buflen) {
-    uint8_t cmd[2] = {0x03, 0xC4};
-    esp_err_t ret = i2c_master_transmit(s_sen5x_dev, cmd, sizeof(cmd), pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        s_last_sen55_diag = map_i2c_err_to_diag(ret, false);
-        return ret;
+uint8_t sensors_trigger(uint8_t mask) {
+    mask = sensors_active(mask);
+    uint8_t failed = 0;
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        if (!driver_present(drv) || !(mask & drv->src) || !drv->trigger) continue;
+        if (drv->on_demand && drv->on_demand() && drv->trigger() != ESP_OK) {
+            failed |= drv->src;
+        }
     }
+    return failed;
+}
 
-    vTaskDelay(pdMS_TO_TICKS(20));
+uint8_t sensors_wait_ready(uint8_t mask, int grace_ms, int margin_ms) {
+    mask = sensors_active(mask);
+    uint8_t ready = 0;
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        if (!driver_present(drv) || !(mask & drv->src)) continue;
+        if (!drv->wait_ready) {
+            ready |= drv->src;
+            continue;
+        }
+        bool on_demand = drv->on_demand && drv->on_demand();
+        int timeout_ms = on_demand ? drv->period_ms() + margin_ms : grace_ms;
+        esp_err_t ret = drv->wait_ready(timeout_ms);
+        if (ret == ESP_OK) {
+            ready |= drv->src;
+        } else {
+            sensor_report(i, ret);
+        }
+    }
+    return ready;
+}
 
-    ret = i2c_master_receive(s_sen5x_dev, buf, buflen, pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        s_last_sen55_diag = map_i2c_err_to_diag(ret, true);
-        return ret;
+uint8_t sensors_read_mask(SensorData *out, uint8_t mask) {
+    if (!out) return 0;
+    mask = sensors_active(mask);
+
+    i2c_txn_t txns[SENSORS_MAX_TXNS];
+    size_t first[SENSORS_N_DRIVERS];
+    size_t count[SENSORS_N_DRIVERS];
+    size_t n = 0;
+
+    // Un solo lote para todos: las esperas de ejecución se solapan
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        first[i] = n;
+        count[i] = 0;
+        if (!driver_present(drv) || !(mask & drv->src)) continue;
+        count[i] = drv->begin(&txns[n], SENSORS_MAX_TXNS - n);
+        n += count[i];
+    }
+    if (n > 0) {
+        i2c_sched_run(txns, n);
     }
 
-    return ESP_OK;
-}
+    uint8_t ok = 0;
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        if (!driver_present(drv) || !(mask & drv->src)) continue;
 
-static int sen5x_decode_measurement(const uint8_t *buf,
-                                    float *pm1,
-                                    float *pm25,
-                                    float *pm4,
-                                    float *pm10,
-                                    float *rh,
-                                    float *temp,
-                                    float *voc_index,
-                                    float *nox_index) {
-    uint16_t values[8];
-
-    for (int i = 0; i < 8; i++) {
-        const uint8_t *data = &buf[i * 3];
-        if (sensirion_crc8(data, 2) != data[2]) {
-            s_last_sen55_diag = SENSOR_DIAG_CRC;
-            return 0;
+        esp_err_t ret = count[i] > 0 ? drv->decode(&txns[first[i]], count[i], out)
+                                     : ESP_ERR_NOT_FINISHED;
+        if (ret == ESP_ERR_NOT_FINISHED) {
+            ret = drv->read(out);
+        }
+        sensor_report(i, ret);
+        if (ret == ESP_OK) {
+            ok |= drv->src;
         }
-        values[i] = ((uint16_t)data[0] << 8) | data[1];
     }
 
-    *pm1       = values[0] / 10.0f;
-    *pm25      = values[1] / 10.0f;
-    *pm4       = values[2] / 10.0f;
-    *pm10      = values[3] / 10.0f;
-    *rh        = values[4] / 100.0f;
-    *temp      = values[5] / 200.0f;
-    *voc_index = values[6] / 10.0f;
-    *nox_index = values[7] / 10.0f;
-
-    return 1;
+    sensors_derive(out, ok);
+    return ok;
 }
 
 // ---------- API ----------
@@ -242,120 +353,67 @@ esp_err_t sensors_init_all(void) {
     esp_err_t ret = i2c_new_master_bus(&bus_cfg, &s_i2c_bus);
     if (ret != ESP_OK) return ret;
 
-    i2c_device_config_t scd_cfg = {
-        .device_address = SCD4X_ADDR,
-        .scl_speed_hz = I2C_MASTER_FREQ_HZ,
-    };
-    ret = i2c_master_bus_add_device(s_i2c_bus, &scd_cfg, &s_scd4x_dev);
-    if (ret != ESP_OK) return ret;
-
-    i2c_device_config_t sen_cfg = {
-        .device_address = SEN5X_ADDR,
-        .scl_speed_hz = I2C_MASTER_FREQ_HZ,
-    };
-    ret = i2c_master_bus_add_device(s_i2c_bus, &sen_cfg, &s_sen5x_dev);
-    if (ret != ESP_OK) return ret;
-
     vTaskDelay(pdMS_TO_TICKS(200));
-    sen5x_device_reset();
-    vTaskDelay(pdMS_TO_TICKS(100));
-    sen5x_start_measurement();
-    vTaskDelay(pdMS_TO_TICKS(50));
-    scd4x_start_measurement();
-    vTaskDelay(pdMS_TO_TICKS(5000));
-
-    sensors_reset_diag();
-    return ESP_OK;
-}
-
-esp_err_t sensors_read_scd40(SensorData *out) {
-    if (!out) return ESP_ERR_INVALID_ARG;
 
-    uint16_t co2 = 0;
-    float temp = 0.0f, hum = 0.0f;
-
-    esp_err_t ret = scd4x_read_measurement(&co2, &temp, &hum);
-
-    // Guardar siempre lo que haya llegado, aunque el valor quede fuera de rango
-    out->co2 = co2;
-    out->scd_temp = temp;
-    out->scd_hum = hum;
-
-    return ret;
-}
-
-esp_err_t sensors_read_sen55(SensorData *out) {
-    if (!out) return ESP_ERR_INVALID_ARG;
-
-    s_last_sen55_diag = SENSOR_DIAG_OK;
-
-    uint8_t data_ready = 0;
-    bool ready = false;
-    esp_err_t ret;
-
-    for (int i = 0; i < SEN55_READY_POLLS; ++i) {
-        ret = sen5x_read_data_ready(&data_ready);
-        if (ret != ESP_OK) {
-            return ret;
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        const sensor_driver_t *drv = s_drivers[i];
+        ret = drv->init(s_i2c_bus);
+        if (ret == ESP_ERR_NOT_FOUND) {
+            ESP_LOGW(TAG_SENS, "%s no detectado; se omite", drv->name);
+            continue;
         }
-
-        if (data_ready == 1) {
-            ready = true;
-            break;
+        s_present |= drv->src;
+        for (uint8_t f = 0; f < drv->n_fields; ++f) {
+            s_present_fields |= 1u << drv->fields[f];
         }
-
-        vTaskDelay(pdMS_TO_TICKS(SEN55_READY_DELAY_MS));
-    }
-
-    if (!ready) {
-        s_last_sen55_diag = SENSOR_DIAG_TIMEOUT;
-        return ESP_ERR_TIMEOUT;
-    }
-
-    uint8_t buf[24];
-    ret = sen5x_read_measured_values(buf, sizeof(buf));
-    if (ret != ESP_OK) {
-        return ret;
-    }
-
-    float pm1, pm25, pm4, pm10, rh, temp, voc, nox;
-    if (!sen5x_decode_measurement(buf, &pm1, &pm25, &pm4, &pm10, &rh, &temp, &voc, &nox)) {
-        return ESP_ERR_INVALID_CRC;
+        if (ret != ESP_OK) {
+            // Está pero falla: queda fuera del bus y sensors_active lo
+            // re-agrega con backoff, igual que a uno que cayó midiendo
+            int diag = drv->diag();
+            if (diag == SENSOR_DIAG_OK) {
+                diag = sensor_map_i2c_err(ret, false);
+            }
+            if (drv->release) {
+                drv->release();
+            }
+            s_detached |= drv->src;
+            sensor_health_init_detached(&s_health[i], diag, esp_timer_get_time());
+            ESP_LOGE(TAG_SENS, "%s: fallo al inicializar: %s; re-agregado en %u s",
+                     drv->name, esp_err_to_name(ret),
+                     (unsigned)(s_health[i].backoff_ms / 1000));
+            continue;
+        }
+        sensor_health_init(&s_health[i]);
+        ESP_LOGI(TAG_SENS, "%s listo (%d campos, cada %d ms)",
+                 drv->name, drv->n_fields, drv->period_ms());
     }
-
-    out->pm1p0 = pm1;
-    out->pm2p5 = pm25;
-    out->pm4p0 = pm4;
-    out->pm10p0 = pm10;
-    out->voc = voc;
-    out->nox = nox;
-    out->sen_temp = temp;
-    out->sen_hum = rh;
-
-    // Promedios solo con la info disponible en esta llamada.
-    // Si antes ya se leyó SCD40 en el mismo struct, esto queda consistente.
-    if (out->scd_temp != 0.0f || out->scd_hum != 0.0f) {
-        out->avg_temp = (out->scd_temp + temp) / 2.0f;
-        out->avg_hum  = (out->scd_hum + rh) / 2.0f;
-    } else {
-        out->avg_temp = temp;
-        out->avg_hum  = rh;
+    // Los derivados siguen al sensor de su src (ver g_sensor_fields)
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        if (g_sensor_fields[f].src & s_present) {
+            s_present_fields |= 1u << f;
+        }
     }
 
-    s_last_sen55_diag = SENSOR_DIAG_OK;
-    return ESP_OK;
+    if (!s_present) return ESP_ERR_NOT_FOUND;
+    return (s_present & ~s_detached) ? ESP_OK : ESP_FAIL;
 }
 
 esp_err_t sensors_read(SensorData *out) {
     if (!out) return ESP_ERR_INVALID_ARG;
 
-    esp_err_t ret = sensors_read_scd40(out);
-    if (ret != ESP_OK) return ret;
-
-    ret = sensors_read_sen55(out);
-    if (ret != ESP_OK) return ret;
-
-    return ESP_OK;
+    // Solo mediciones nuevas: read_measurement repetiría la anterior
+    if (sensors_on_demand()) {
+        sensors_trigger(s_present);
+    }
+    int period_ms = 0;
+    for (size_t i = 0; i < SENSORS_N_DRIVERS; ++i) {
+        if (driver_present(s_drivers[i]) && s_drivers[i]->period_ms() > period_ms) {
+            period_ms = s_drivers[i]->period_ms();
+        }
+    }
+    uint8_t ready = sensors_wait_ready(s_present, period_ms, 1000);
+    uint8_t ok = sensors_read_mask(out, ready);
+    return ok == s_present ? ESP_OK : ESP_FAIL;
 }
 
 void sensors_format_json(const SensorData *d,
@@ -366,28 +424,19 @@ void sensors_format_json(const SensorData *d,
                          size_t buf_size) {
     if (!buf || buf_size == 0 || !d) return;
 
-    int written = snprintf(
-        buf, buf_size,
-        "{\"pm1p0\":%.2f,\"pm2p5\":%.2f,\"pm4p0\":%.2f,\"pm10p0\":%.2f,"
-        "\"voc\":%.1f,\"nox\":%.1f,\"cTe\":%.2f,\"cHu\":%.2f,\"co2\":%u,"
-        "\"fecha\":\"%s\",\"inicio\":\"%s\",\"ciudad\":\"%s\","
-        "\"hora\":\"%s\",\"device_id\":\"%s\"}",
-        d->pm1p0, d->pm2p5, d->pm4p0, d->pm10p0,
-        d->voc, d->nox, d->avg_temp, d->avg_hum, d->co2,
-        fecha_str, inicio_str, g_city_state, time_str, DEVICE_ID
-    );
-
-    if (written < 0 || (size_t)written >= buf_size) {
-        buf[buf_size - 1] = '\0';
-    }
+    payload_json_src_t src = {
+        .avg = d,
+        .fecha = fecha_str,
+        .hora = time_str,
+        .inicio = inicio_str,
+    };
+    payload_json_write(&src,
+                       PAYLOAD_JSON_FECHA | PAYLOAD_JSON_INICIO |
+                       PAYLOAD_JSON_CIUDAD | PAYLOAD_JSON_DEVICE_ID,
+                       buf, buf_size);
 }
 
 void sensors_set_city_state(const char *city_state) {
     if (!city_state) return;
-
-    size_t len = strlen(city_state);
-    if (len >= sizeof(g_city_state)) len = sizeof(g_city_state) - 1;
-
-    memcpy(g_city_state, city_state, len);
-    g_city_state[len] = '\0';
-}
\ No newline at end of file
+    payload_json_set_city(city_state);
+}
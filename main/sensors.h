@@ -1,5 +1,6 @@
 #pragma once
 #include "esp_err.h"
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -35,17 +36,96 @@ typedef enum {
     SENSOR_DIAG_OTHER        = 99   // 99
 } sensor_diag_code_t;
 
-// Inicializa I2C y ambos sensores
+// Modos de medición del SCD4x
+typedef enum {
+    SCD40_MODE_PERIODIC = 0,   // start_periodic_measurement: una medición cada 5 s
+    SCD40_MODE_LOW_POWER,      // start_low_power_periodic_measurement: cada 30 s
+    SCD40_MODE_SINGLE_SHOT,    // measure_single_shot bajo demanda (solo SCD41/43)
+} scd40_mode_t;
+
+// Antigüedad máxima de la lectura del SCD40 que entra en cTe/cHu; más
+// vieja, cTe/cHu salen solo del SEN55
+#define SENSORS_DERIVE_MAX_AGE_MS  (2 * 60 * 1000)
+
+// Inicializa I2C y los sensores registrados (sensor_driver.h). Los que no
+// responden al sondeo (NACK) se omiten; los que fallan de otra forma
+// (timeout, I2C, CRC) quedan presentes pero fuera del bus, y se re-agregan
+// con backoff como cualquier sensor caído. ESP_ERR_NOT_FOUND si no hay
+// ninguno presente; ESP_FAIL si ninguno quedó en el bus.
 esp_err_t sensors_init_all(void);
 
-// Lectura separada por sensor
+// ---------- Registro de drivers ----------
+// Las máscaras llevan un bit por driver: su SENSOR_FIELD_SRC_* (= SAMPLE_FLAG_*).
+struct sensor_driver;
+
+uint8_t sensors_present_mask(void);
+uint32_t sensors_present_fields(void);      // bits (1 << sensor_field_t)
+size_t sensors_driver_count(void);
+const struct sensor_driver *sensors_driver_get(size_t i);
+
+// Los sensores que fallan seguido se recuperan solos (sensor_health.h):
+// reset suave, recuperación del bus y re-agregado, con backoff; mientras
+// tanto trigger/wait_ready/read_mask los saltean.
+// {"SCD4x":{"st":"ok","ok":N,"fail":N,...},...} de los presentes; -1 si no entra.
+int sensors_health_format_json(char *buf, size_t len);
+void sensors_health_log(void);
+
+// Espera la próxima medición del primer sensor periódico con data-ready,
+// para alinear la grilla de muestreo a su cadencia.
+esp_err_t sensors_align(int margin_ms);
+
+// true si algún sensor presente mide solo al dispararlo (single-shot)
+bool sensors_on_demand(void);
+
+// Dispara los sensores a demanda de mask. Devuelve los que fallaron.
+uint8_t sensors_trigger(uint8_t mask);
+
+// Espera medición nueva de los sensores de mask: hasta grace_ms los
+// periódicos; los disparados, su tiempo de medición + margin_ms.
+// Devuelve los listos.
+uint8_t sensors_wait_ready(uint8_t mask, int grace_ms, int margin_ms);
+
+// Lee los sensores de mask en un solo lote intercalado del bus y completa
+// los campos derivados. Devuelve los que leyeron bien.
+uint8_t sensors_read_mask(SensorData *out, uint8_t mask);
+
+// Wrapper opcional: espera y lee todos los sensores presentes
+esp_err_t sensors_read(SensorData *out);
+
+// ---------- SCD4x (scd4x.c) ----------
 esp_err_t sensors_read_scd40(SensorData *out);
+
+// Espera (hasta timeout_ms) a que el SCD40 tenga una medición nueva.
+esp_err_t sensors_scd40_wait_ready(int timeout_ms);
+
+// Modo recomendado para muestrear cada period_ms: por debajo de 30 s el
+// periódico normal; hasta 1 min el de bajo consumo; más lento, single-shot
+// (el sensor queda en reposo entre muestras).
+scd40_mode_t sensors_scd40_mode_for_period(int period_ms);
+
+// Cambia el modo del SCD40 (sale de medición periódica si hace falta). Si el
+// sensor no acepta single-shot (SCD40) queda en bajo consumo.
+esp_err_t sensors_scd40_set_mode(scd40_mode_t mode);
+scd40_mode_t sensors_scd40_get_mode(void);
+
+// Tiempo entre mediciones del modo actual (single-shot: lo que tarda una)
+int sensors_scd40_interval_ms(void);
+
+// En single-shot dispara una medición (lista en sensors_scd40_interval_ms());
+// en los modos periódicos no hace nada.
+esp_err_t sensors_scd40_trigger(void);
+
+int sensors_get_last_scd40_diag(void);
+
+// ---------- SEN5x (sen5x.c) ----------
+// Espera data-ready (sondeo) y lee
 esp_err_t sensors_read_sen55(SensorData *out);
 
-// Wrapper opcional: lee ambos sensores
-esp_err_t sensors_read(SensorData *out);
+int sensors_get_last_sen55_diag(void);
 
-// Formatea JSON con claves personalizadas.
+// ---------- Formato ----------
+// Formatea JSON con claves personalizadas (mismo serializador que las
+// ventanas, payload_json.h).
 // time_str e inicio_str deben ir en formato "HH:MM:SS".
 // fecha_str debe ir en formato "DD-MM-YYYY".
 void sensors_format_json(const SensorData *d,
@@ -57,8 +137,3 @@ void sensors_format_json(const SensorData *d,
 
 // Establece ciudad (city-state) obtenida externamente
 void sensors_set_city_state(const char *city_state);
-
-// Getters de diagnóstico del último intento
-int sensors_get_last_scd40_diag(void);
-int sensors_get_last_sen55_diag(void);
-void sensors_reset_diag(void);
\ No newline at end of file
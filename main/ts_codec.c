@@ -0,0 +1,329 @@
+#include "ts_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+static const float s_scale[] = { 1.0f, 10.0f, 100.0f, 1000.0f };
+
+static float field_scale(int f)
+{
+    uint8_t d = g_sensor_fields[f].decimals;
+    return s_scale[d < sizeof(s_scale) / sizeof(s_scale[0]) ? d : 0];
+}
+
+// NaN va como TS_Q_NAN; el resto se satura a [INT32_MIN + 1, INT32_MAX]
+static int32_t quantize(float v, float scale)
+{
+    if (isnan(v)) {
+        return TS_Q_NAN;
+    }
+    float q = roundf(v * scale);
+    if (q < -2147483520.0f) {
+        return INT32_MIN + 1;
+    }
+    if (q > 2147483520.0f) {
+        return INT32_MAX;
+    }
+    return (int32_t)q;
+}
+
+static float dequantize(int32_t q, float scale)
+{
+    return q == TS_Q_NAN ? NAN : (float)q / scale;
+}
+
+// Base del delta de un campo: un campo sin dato (TS_Q_NAN, p.ej. al empezar
+// el bloque) cuenta como 0, así el primer valor no paga el salto desde INT32_MIN
+static int64_t q_base(int32_t q_prev)
+{
+    return q_prev == TS_Q_NAN ? 0 : q_prev;
+}
+
+// Los deltas de enteros de 32 bits (y de delta de tiempos) llegan a 33
+// bits: el zig-zag va en 64
+static uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t u)
+{
+    return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+}
+
+// ---------- Bits ----------
+static void put_bits(ts_enc_t *e, uint32_t v, int n)
+{
+    if (e->overflow) {
+        return;
+    }
+    if (e->bitpos + (size_t)n > e->cap * 8) {
+        e->overflow = true;
+        return;
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        size_t byte = e->bitpos >> 3;
+        int bit = 7 - (int)(e->bitpos & 7);
+        if (bit == 7) {
+            e->buf[byte] = 0;
+        }
+        e->buf[byte] |= (uint8_t)(((v >> i) & 1u) << bit);
+        e->bitpos++;
+    }
+}
+
+static bool get_bits(ts_dec_t *d, int n, uint32_t *out)
+{
+    if (d->bitpos + (size_t)n > d->len * 8) {
+        return false;
+    }
+    uint32_t v = 0;
+    for (int i = 0; i < n; ++i) {
+        size_t byte = d->bitpos >> 3;
+        int bit = 7 - (int)(d->bitpos & 7);
+        v = (v << 1) | ((d->buf[byte] >> bit) & 1u);
+        d->bitpos++;
+    }
+    *out = v;
+    return true;
+}
+
+// Prefijo de largo variable: '0' | '10'+6 | '110'+13 | '1110'+20 | '1111'+64
+static void put_uvar(ts_enc_t *e, uint64_t u)
+{
+    if (u == 0) {
+        put_bits(e, 0x0, 1);
+    } else if (u < (1u << 6)) {
+        put_bits(e, 0x2, 2);
+        put_bits(e, u, 6);
+    } else if (u < (1u << 13)) {
+        put_bits(e, 0x6, 3);
+        put_bits(e, (uint32_t)u, 13);
+    } else if (u < (1u << 20)) {
+        put_bits(e, 0xE, 4);
+        put_bits(e, (uint32_t)u, 20);
+    } else {
+        put_bits(e, 0xF, 4);
+        put_bits(e, (uint32_t)(u >> 32), 32);
+        put_bits(e, (uint32_t)u, 32);
+    }
+}
+
+static bool get_uvar(ts_dec_t *d, uint64_t *u)
+{
+    static const int widths[] = { 0, 6, 13, 20 };
+    int ones = 0;
+    uint32_t bit;
+    while (ones < 4) {
+        if (!get_bits(d, 1, &bit)) {
+            return false;
+        }
+        if (!bit) {
+            break;
+        }
+        ones++;
+    }
+    if (ones == 0) {
+        *u = 0;
+        return true;
+    }
+    uint32_t hi = 0, lo;
+    if (ones == 4 && !get_bits(d, 32, &hi)) {
+        return false;
+    }
+    if (!get_bits(d, ones == 4 ? 32 : widths[ones], &lo)) {
+        return false;
+    }
+    *u = ((uint64_t)hi << 32) | lo;
+    return true;
+}
+
+static void put_le(uint8_t *p, uint32_t v, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_le(const uint8_t *p, int n)
+{
+    uint32_t v = 0;
+    for (int i = n - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// ---------- Encoder ----------
+esp_err_t ts_enc_init(ts_enc_t *e, uint8_t *buf, size_t cap, uint16_t fields,
+                      uint32_t base_epoch)
+{
+    if (!e || !buf || cap < TS_CODEC_HEADER_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *e = (ts_enc_t){
+        .buf = buf,
+        .cap = cap,
+        .bitpos = TS_CODEC_HEADER_LEN * 8,
+        .fields = fields & ((1u << SENSOR_FIELD_COUNT) - 1),
+        .base_epoch = base_epoch,
+    };
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        e->q_prev[f] = TS_Q_NAN;
+    }
+    memset(buf, 0, TS_CODEC_HEADER_LEN);
+    return ESP_OK;
+}
+
+esp_err_t ts_enc_add(ts_enc_t *e, uint32_t t_ms, uint8_t flags, const SensorData *d)
+{
+    if (e->count == UINT16_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Para deshacer si no entra
+    ts_enc_t saved = *e;
+
+    if (e->count == 1) {
+        e->dt_prev = (int64_t)t_ms - e->t_prev;
+        put_uvar(e, zigzag(e->dt_prev));
+    } else if (e->count > 1) {
+        int64_t dt = (int64_t)t_ms - e->t_prev;
+        put_uvar(e, zigzag(dt - e->dt_prev));
+        e->dt_prev = dt;
+    }
+    e->t_prev = t_ms;
+
+    if (flags == e->flags_prev && e->count > 0) {
+        put_bits(e, 0, 1);
+    } else {
+        put_bits(e, 1, 1);
+        put_bits(e, flags, 8);
+        e->flags_prev = flags;
+    }
+
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        if (!(e->fields & (1u << f)) || !(flags & g_sensor_fields[f].src)) {
+            continue;
+        }
+        int32_t q = quantize(sensor_field_get(d, (sensor_field_t)f), field_scale(f));
+        put_uvar(e, zigzag((int64_t)q - q_base(e->q_prev[f])));
+        e->q_prev[f] = q;
+    }
+
+    if (e->overflow) {
+        size_t bitpos = saved.bitpos;
+        *e = saved;
+        if (bitpos & 7) {
+            e->buf[bitpos >> 3] &= (uint8_t)(0xFF << (8 - (bitpos & 7)));
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (e->count == 0) {
+        put_le(e->buf + 12, t_ms, 4);
+    }
+    e->count++;
+    return ESP_OK;
+}
+
+size_t ts_enc_finish(ts_enc_t *e)
+{
+    uint8_t *h = e->buf;
+    h[0] = 'T';
+    h[1] = 'S';
+    h[2] = TS_CODEC_VERSION;
+    h[3] = 0;
+    put_le(h + 4, e->fields, 2);
+    put_le(h + 6, e->count, 2);
+    put_le(h + 8, e->base_epoch, 4);
+    return (e->bitpos + 7) / 8;
+}
+
+// ---------- Decoder ----------
+esp_err_t ts_dec_init(ts_dec_t *d, const uint8_t *buf, size_t len)
+{
+    if (!d || !buf || len < TS_CODEC_HEADER_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (buf[0] != 'T' || buf[1] != 'S' || buf[2] != TS_CODEC_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    *d = (ts_dec_t){
+        .buf = buf,
+        .len = len,
+        .bitpos = TS_CODEC_HEADER_LEN * 8,
+        .fields = (uint16_t)get_le(buf + 4, 2),
+        .count = (uint16_t)get_le(buf + 6, 2),
+        .base_epoch = get_le(buf + 8, 4),
+        .t_prev = get_le(buf + 12, 4),
+    };
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        d->q_prev[f] = TS_Q_NAN;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ts_dec_next(ts_dec_t *d, uint32_t *t_ms, uint8_t *flags, SensorData *out)
+{
+    if (d->index >= d->count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint64_t u;
+    uint32_t bits;
+    if (d->index == 1) {
+        if (!get_uvar(d, &u)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        d->dt_prev = unzigzag(u);
+        d->t_prev = (uint32_t)((int64_t)d->t_prev + d->dt_prev);
+    } else if (d->index > 1) {
+        if (!get_uvar(d, &u)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        d->dt_prev += unzigzag(u);
+        d->t_prev = (uint32_t)((int64_t)d->t_prev + d->dt_prev);
+    }
+
+    if (!get_bits(d, 1, &bits)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (bits) {
+        if (!get_bits(d, 8, &bits)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        d->flags_prev = (uint8_t)bits;
+    }
+
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        if (!(d->fields & (1u << f)) || !(d->flags_prev & g_sensor_fields[f].src)) {
+            continue;
+        }
+        if (!get_uvar(d, &u)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        d->q_prev[f] = (int32_t)(q_base(d->q_prev[f]) + unzigzag(u));
+    }
+
+    if (out) {
+        for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+            if (d->fields & (1u << f)) {
+                sensor_field_set(out, (sensor_field_t)f, dequantize(d->q_prev[f], field_scale(f)));
+            }
+        }
+    }
+    if (t_ms) {
+        *t_ms = d->t_prev;
+    }
+    if (flags) {
+        *flags = d->flags_prev;
+    }
+    d->index++;
+    return ESP_OK;
+}
+
+bool ts_dec_has_value(const ts_dec_t *d, sensor_field_t f)
+{
+    return f < SENSOR_FIELD_COUNT && (d->fields & (1u << f)) && d->q_prev[f] != TS_Q_NAN;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sensor_fields.h"
+#include "sensors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Códec de series de SensorData al estilo Gorilla, para historial y
+// muestras crudas: un bloque = cabecera + flujo de bits (MSB primero).
+//
+// Cabecera (16 bytes, little-endian):
+//   0  'T' 'S'     2  versión (3)     3  reservado (0)
+//   4  campos (u16, bits 1 << sensor_field_t)
+//   6  muestras (u16)
+//   8  base (u32, epoch en s)
+//  12  t0 (u32, ms desde base de la primera muestra)
+//
+// Por muestra:
+//   tiempo   1ª: nada (t0); 2ª: delta; siguientes: delta del delta
+//   flags    '0' = iguales a la anterior; '1' + 8 bits (SAMPLE_FLAG_*)
+//   valores  por cada campo del bloque cuyo sensor está en flags: delta
+//            contra el último valor de ese campo, como entero de 32 bits
+//            escalado a los decimales del JSON (g_sensor_fields), igual que
+//            el CBOR. INT32_MIN (TS_Q_NAN) = NaN / sin dato; los valores
+//            fuera de rango se saturan a [INT32_MIN + 1, INT32_MAX]. Cada
+//            campo arranca el bloque en TS_Q_NAN (sin dato hasta que su
+//            sensor aparece en flags); si el último es TS_Q_NAN el delta va
+//            contra 0.
+//
+// Tiempos y deltas van en zig-zag (64 bits: un delta entre enteros de 32
+// ocupa 33) con prefijo de largo variable:
+//   '0' = 0 | '10' + 6 bits | '110' + 13 | '1110' + 20 | '1111' + 64
+//
+// Con cadencia fija y valores que cambian poco, una muestra de 11 campos
+// ocupa del orden de 10-15 bytes frente a ~250 de JSON.
+
+#define TS_CODEC_CONTENT_TYPE "application/x-sensor-ts"
+#define TS_CODEC_HEADER_LEN   16
+#define TS_CODEC_VERSION      3
+#define TS_Q_NAN              INT32_MIN
+
+typedef struct {
+    uint8_t *buf;
+    size_t   cap;
+    size_t   bitpos;
+    bool     overflow;
+
+    uint16_t fields;
+    uint16_t count;
+    uint32_t base_epoch;
+    uint32_t t_prev;
+    int64_t  dt_prev;
+    uint8_t  flags_prev;
+    int32_t  q_prev[SENSOR_FIELD_COUNT];
+} ts_enc_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t   len;
+    size_t   bitpos;
+
+    uint16_t fields;
+    uint16_t count;
+    uint16_t index;
+    uint32_t base_epoch;
+    uint32_t t_prev;
+    int64_t  dt_prev;
+    uint8_t  flags_prev;
+    int32_t  q_prev[SENSOR_FIELD_COUNT];
+} ts_dec_t;
+
+// Empieza un bloque en buf con los campos de fields; los tiempos van en ms
+// desde base_epoch. Si cap no alcanza ni para la cabecera,
+// ESP_ERR_INVALID_SIZE.
+esp_err_t ts_enc_init(ts_enc_t *e, uint8_t *buf, size_t cap, uint16_t fields,
+                      uint32_t base_epoch);
+
+// Agrega una muestra (t_ms desde base_epoch, no decreciente). Si no entra devuelve
+// ESP_ERR_NO_MEM y el bloque queda como estaba, listo para cerrar.
+esp_err_t ts_enc_add(ts_enc_t *e, uint32_t t_ms, uint8_t flags, const SensorData *d);
+
+// Cierra el bloque (cuenta de muestras en la cabecera). Devuelve los bytes
+// usados.
+size_t ts_enc_finish(ts_enc_t *e);
+
+// Decodificador de referencia (mismo esquema), para herramientas del lado
+// servidor y pruebas en host.
+esp_err_t ts_dec_init(ts_dec_t *d, const uint8_t *buf, size_t len);
+
+// Siguiente muestra (t_ms desde d->base_epoch); ESP_ERR_NOT_FOUND al terminar. Los campos ausentes en
+// flags quedan con su último valor (NaN si su sensor todavía no apareció en
+// el bloque).
+esp_err_t ts_dec_next(ts_dec_t *d, uint32_t *t_ms, uint8_t *flags, SensorData *out);
+
+// false si el campo no tiene dato en la última muestra decodificada (NaN, o
+// su sensor todavía no apareció en el bloque). Para CO2, que en SensorData
+// es entero y queda en 0, es la única forma de distinguirlo.
+bool ts_dec_has_value(const ts_dec_t *d, sensor_field_t f);
+
+#ifdef __cplusplus
+}
+#endif
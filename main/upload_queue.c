@@ -0,0 +1,349 @@
+#include "upload_queue.h"
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "upload_queue";
+
+/*
+ * Layout: la particion se divide en slots fijos de UPLOAD_QUEUE_SLOT_SIZE.
+ * Cada entrada lleva un numero de secuencia monotono y vive en el slot
+ * (seq % n_slots), asi la cola es un anillo que recorre toda la flash de forma
+ * pareja (wear leveling natural). Un sector se borra solo cuando la cabeza
+ * entra en el.
+ *
+ * Escritura: payload primero, encabezado despues. Si se corta la energia a
+ * medias, el magic o el CRC no cuadran y el slot se ignora al escanear.
+ * Confirmacion: se programa state=0 sobre el mismo encabezado (1->0 sin borrar).
+ */
+
+#define UPQ_MAGIC         0x51505545u   // "EUPQ"
+#define UPQ_STATE_PENDING 0xFFFFFFFFu
+#define UPQ_STATE_SENT    0x00000000u
+#define UPQ_SECTOR_SIZE   4096
+#define UPQ_SLOTS_PER_SECTOR (UPQ_SECTOR_SIZE / UPLOAD_QUEUE_SLOT_SIZE)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t ts;
+    uint16_t len;
+    uint16_t reserved;
+    uint32_t crc;       // crc32(seq, ts, len, payload)
+    uint32_t state;
+} upq_hdr_t;
+
+_Static_assert(sizeof(upq_hdr_t) == UPLOAD_QUEUE_SLOT_SIZE - UPLOAD_QUEUE_MAX_PAYLOAD,
+               "encabezado upq desalineado con UPLOAD_QUEUE_MAX_PAYLOAD");
+
+static const esp_partition_t *s_part = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static uint32_t s_n_slots = 0;
+static uint32_t s_head_seq = 0;   // siguiente seq a escribir
+static uint32_t s_tail_seq = 0;   // seq pendiente mas vieja
+static upload_queue_stats_t s_stats;
+
+static size_t slot_offset(uint32_t seq)
+{
+    return (size_t)(seq % s_n_slots) * UPLOAD_QUEUE_SLOT_SIZE;
+}
+
+static uint32_t entry_crc(const upq_hdr_t *h, const void *payload)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&h->seq, sizeof(h->seq));
+    crc = esp_rom_crc32_le(crc, (const uint8_t *)&h->ts, sizeof(h->ts));
+    crc = esp_rom_crc32_le(crc, (const uint8_t *)&h->len, sizeof(h->len));
+    return esp_rom_crc32_le(crc, (const uint8_t *)payload, h->len);
+}
+
+static bool read_hdr(uint32_t seq, upq_hdr_t *h)
+{
+    if (esp_partition_read(s_part, slot_offset(seq), h, sizeof(*h)) != ESP_OK) {
+        return false;
+    }
+    return h->magic == UPQ_MAGIC && h->seq == seq && h->len <= UPLOAD_QUEUE_MAX_PAYLOAD;
+}
+
+esp_err_t upload_queue_init(void)
+{
+    if (s_part) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY,
+                                                           UPLOAD_QUEUE_PARTITION_LABEL);
+    if (!part) {
+        ESP_LOGE(TAG, "Particion '%s' no encontrada; cola deshabilitada",
+                 UPLOAD_QUEUE_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint32_t n_slots = part->size / UPLOAD_QUEUE_SLOT_SIZE;
+    n_slots -= n_slots % UPQ_SLOTS_PER_SECTOR;
+    if (n_slots < 2 * UPQ_SLOTS_PER_SECTOR) {
+        ESP_LOGE(TAG, "Particion '%s' demasiado chica (%u bytes)",
+                 UPLOAD_QUEUE_PARTITION_LABEL, (unsigned)part->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_part = part;
+    s_n_slots = n_slots;
+
+    // Recupera cabeza (seq maxima + 1) y cola (seq pendiente minima).
+    bool any = false;
+    bool any_pending = false;
+    uint32_t max_seq = 0;
+    uint32_t min_pending = 0;
+    for (uint32_t i = 0; i < n_slots; ++i) {
+        upq_hdr_t h;
+        if (esp_partition_read(part, (size_t)i * UPLOAD_QUEUE_SLOT_SIZE, &h, sizeof(h)) != ESP_OK ||
+            h.magic != UPQ_MAGIC || h.seq % n_slots != i) {
+            continue;
+        }
+        if (!any || h.seq > max_seq) {
+            max_seq = h.seq;
+        }
+        any = true;
+        if (h.state == UPQ_STATE_PENDING && (!any_pending || h.seq < min_pending)) {
+            min_pending = h.seq;
+            any_pending = true;
+        }
+    }
+
+    s_head_seq = any ? max_seq + 1 : 0;
+    s_tail_seq = any_pending ? min_pending : s_head_seq;
+    // Lo que quede fuera de la ventana del anillo ya fue pisado
+    if (s_head_seq - s_tail_seq > n_slots) {
+        s_tail_seq = s_head_seq - n_slots;
+    }
+
+    s_stats.capacity = n_slots - UPQ_SLOTS_PER_SECTOR;
+    s_stats.pending = s_head_seq - s_tail_seq;
+    ESP_LOGI(TAG, "Cola lista: %u slots, %u pendientes (seq %u..%u)",
+             (unsigned)s_stats.capacity, (unsigned)s_stats.pending,
+             (unsigned)s_tail_seq, (unsigned)s_head_seq);
+    return ESP_OK;
+}
+
+bool upload_queue_is_ready(void)
+{
+    return s_part != NULL;
+}
+
+esp_err_t upload_queue_push(const char *payload, size_t len, uint32_t ts)
+{
+    if (!payload || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len > UPLOAD_QUEUE_MAX_PAYLOAD) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!s_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    uint32_t seq = s_head_seq;
+    size_t off = slot_offset(seq);
+    esp_err_t err = ESP_OK;
+
+    if ((seq % UPQ_SLOTS_PER_SECTOR) == 0) {
+        // Entrando a un sector nuevo: si aun tiene pendientes, se pierden los mas viejos
+        uint32_t keep_from = seq + UPQ_SLOTS_PER_SECTOR - s_n_slots;
+        if (seq + UPQ_SLOTS_PER_SECTOR > s_n_slots && s_tail_seq < keep_from) {
+            uint32_t lost = keep_from - s_tail_seq;
+            s_stats.dropped += lost;
+            s_tail_seq = keep_from;
+            ESP_LOGW(TAG, "Cola llena: se descartan %u entradas viejas", (unsigned)lost);
+        }
+        err = esp_partition_erase_range(s_part, off, UPQ_SECTOR_SIZE);
+    }
+
+    upq_hdr_t h = {
+        .magic = UPQ_MAGIC,
+        .seq = seq,
+        .ts = ts,
+        .len = (uint16_t)len,
+        .reserved = 0xFFFF,
+        .state = UPQ_STATE_PENDING,
+    };
+    h.crc = entry_crc(&h, payload);
+
+    if (err == ESP_OK) {
+        err = esp_partition_write(s_part, off + sizeof(h), payload, len);
+    }
+    if (err == ESP_OK) {
+        err = esp_partition_write(s_part, off, &h, sizeof(h));
+    }
+
+    if (err == ESP_OK) {
+        s_head_seq = seq + 1;
+        s_stats.pushed++;
+        s_stats.pending = s_head_seq - s_tail_seq;
+    } else {
+        // El slot queda invalido; se salta y la siguiente entrada usa el que sigue
+        s_head_seq = seq + 1;
+        if (s_tail_seq == seq) {
+            s_tail_seq = s_head_seq;
+        }
+        s_stats.pending = s_head_seq - s_tail_seq;
+        ESP_LOGE(TAG, "No se pudo escribir seq=%u: %s", (unsigned)seq, esp_err_to_name(err));
+    }
+
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+esp_err_t upload_queue_peek(char *buf, size_t buf_size, size_t *out_len,
+                            uint32_t *out_ts)
+{
+    if (!buf || buf_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    while (s_tail_seq != s_head_seq) {
+        upq_hdr_t h;
+        if (read_hdr(s_tail_seq, &h) && h.state == UPQ_STATE_PENDING) {
+            if ((size_t)h.len + 1 > buf_size) {
+                err = ESP_ERR_INVALID_SIZE;
+                break;
+            }
+            err = esp_partition_read(s_part, slot_offset(s_tail_seq) + sizeof(h), buf, h.len);
+            if (err == ESP_OK && entry_crc(&h, buf) == h.crc) {
+                buf[h.len] = '\0';
+                if (out_len) *out_len = h.len;
+                if (out_ts) *out_ts = h.ts;
+                break;
+            }
+        }
+        // Slot roto o ya confirmado: se salta
+        ESP_LOGW(TAG, "Entrada seq=%u invalida; se salta", (unsigned)s_tail_seq);
+        s_stats.corrupt++;
+        s_tail_seq++;
+        err = ESP_ERR_NOT_FOUND;
+    }
+    s_stats.pending = s_head_seq - s_tail_seq;
+
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+esp_err_t upload_queue_peek_at(uint32_t index, char *buf, size_t buf_size,
+                               size_t *out_len, uint32_t *out_ts)
+{
+    if (index == 0) {
+        return upload_queue_peek(buf, buf_size, out_len, out_ts);
+    }
+    if (!buf || buf_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    if (index < s_head_seq - s_tail_seq) {
+        uint32_t seq = s_tail_seq + index;
+        upq_hdr_t h;
+        err = ESP_ERR_INVALID_CRC;
+        if (read_hdr(seq, &h) && h.state == UPQ_STATE_PENDING) {
+            if ((size_t)h.len + 1 > buf_size) {
+                err = ESP_ERR_INVALID_SIZE;
+            } else if (esp_partition_read(s_part, slot_offset(seq) + sizeof(h), buf, h.len) == ESP_OK &&
+                       entry_crc(&h, buf) == h.crc) {
+                buf[h.len] = '\0';
+                if (out_len) *out_len = h.len;
+                if (out_ts) *out_ts = h.ts;
+                err = ESP_OK;
+            }
+        }
+    }
+
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+esp_err_t upload_queue_oldest_ts(uint32_t *out_ts)
+{
+    if (!out_ts) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    if (s_tail_seq != s_head_seq) {
+        upq_hdr_t h;
+        if (read_hdr(s_tail_seq, &h)) {
+            *out_ts = h.ts;
+            err = ESP_OK;
+        } else {
+            err = ESP_ERR_INVALID_CRC;
+        }
+    }
+
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+esp_err_t upload_queue_pop(void)
+{
+    if (!s_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    if (s_tail_seq != s_head_seq) {
+        uint32_t sent = UPQ_STATE_SENT;
+        err = esp_partition_write(s_part,
+                                  slot_offset(s_tail_seq) + offsetof(upq_hdr_t, state),
+                                  &sent, sizeof(sent));
+        // Aun si falla la marca, se avanza en RAM; en el peor caso tras un
+        // reinicio la entrada se reenvia una vez (duplicado, no perdida).
+        s_tail_seq++;
+        s_stats.popped++;
+        s_stats.pending = s_head_seq - s_tail_seq;
+    }
+
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+uint32_t upload_queue_count(void)
+{
+    return s_part ? s_head_seq - s_tail_seq : 0;
+}
+
+void upload_queue_get_stats(upload_queue_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    *out = s_stats;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cola FIFO persistente (particion "upq") de payloads que no se pudieron
+// enviar. Sobrevive reinicios y cortes de energia; la RAM usada es constante.
+
+#define UPLOAD_QUEUE_PARTITION_LABEL "upq"
+#define UPLOAD_QUEUE_SLOT_SIZE       1024
+#define UPLOAD_QUEUE_MAX_PAYLOAD     (UPLOAD_QUEUE_SLOT_SIZE - 24)
+
+typedef struct {
+    uint32_t capacity;      // entradas garantizadas antes de descartar
+    uint32_t pending;       // entradas sin enviar
+    uint32_t pushed;        // encoladas desde el arranque
+    uint32_t popped;        // confirmadas desde el arranque
+    uint32_t dropped;       // descartadas por cola llena (las mas viejas)
+    uint32_t corrupt;       // slots con CRC invalido saltados
+} upload_queue_stats_t;
+
+// Monta la particion y reconstruye cabeza/cola escaneando los encabezados.
+esp_err_t upload_queue_init(void);
+
+bool upload_queue_is_ready(void);
+
+// Encola un payload (len <= UPLOAD_QUEUE_MAX_PAYLOAD). ts = epoch del envio.
+// Si la cola esta llena se descarta el sector mas viejo.
+esp_err_t upload_queue_push(const char *payload, size_t len, uint32_t ts);
+
+// Copia la entrada mas vieja en buf (terminada en '\0').
+// ESP_ERR_NOT_FOUND si la cola esta vacia.
+esp_err_t upload_queue_peek(char *buf, size_t buf_size, size_t *out_len,
+                            uint32_t *out_ts);
+
+// Copia la entrada index (0 = la mas vieja) sin consumirla, para armar lotes.
+// Con index > 0 un slot roto devuelve ESP_ERR_INVALID_CRC (el lote se corta
+// ahi; upload_queue_peek lo saltara cuando llegue a ser la mas vieja).
+esp_err_t upload_queue_peek_at(uint32_t index, char *buf, size_t buf_size,
+                               size_t *out_len, uint32_t *out_ts);
+
+// Epoch de encolado de la entrada mas vieja. ESP_ERR_NOT_FOUND si vacia.
+esp_err_t upload_queue_oldest_ts(uint32_t *out_ts);
+
+// Marca como enviada la entrada mas vieja.
+esp_err_t upload_queue_pop(void);
+
+uint32_t upload_queue_count(void);
+
+void upload_queue_get_stats(upload_queue_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include "sensors.h"
+#include "sensor_fields.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Dispersión de un campo dentro de la ventana (la media va en avg)
+typedef struct {
+    float    std;
+    float    min;
+    float    max;
+    uint16_t n;              // muestras válidas del campo
+    uint16_t used;           // muestras que entran en avg (sin descartadas)
+} window_field_summary_t;
+
+// Ventana de promedio terminada (la produce agg_task, la consume upload_task)
+typedef struct {
+    SensorData avg;           // promedio de la ventana
+    uint32_t   start_epoch;   // primera muestra (epoch UTC)
+    uint32_t   end_epoch;     // cierre de la ventana (epoch UTC; hora del JSON)
+    uint16_t   scd_samples;   // muestras SCD40 válidas
+    uint16_t   sen_samples;   // muestras SEN55 válidas
+    uint16_t   missed_slots;  // slots de muestreo saltados por atraso
+    uint16_t   jitter_avg_ms; // |instante de muestra - deadline| promedio
+    uint16_t   jitter_max_ms;
+    window_field_summary_t stats[SENSOR_FIELD_COUNT];
+    uint8_t    agg[SENSOR_FIELD_COUNT];   // window_agg_t aplicado a avg
+} window_record_t;
+
+#ifdef __cplusplus
+}
+#endif
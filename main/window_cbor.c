@@ -0,0 +1,315 @@
+#include "window_cbor.h"
+
+#include <math.h>
+#include <string.h>
+
+// Claves del mapa (ver tabla en window_cbor.h)
+enum {
+    WCB_DEVICE_ID = 0,
+    WCB_END_EPOCH,
+    WCB_CO2,
+    WCB_PM1P0,
+    WCB_PM2P5,
+    WCB_PM4P0,
+    WCB_PM10P0,
+    WCB_VOC,
+    WCB_NOX,
+    WCB_CTE,
+    WCB_CHU,
+    WCB_SEN_TEMP,
+    WCB_SEN_HUM,
+    WCB_VER,
+    WCB_CIUDAD,
+    WCB_INICIO,
+    WCB_SCD_SAMPLES,
+    WCB_SEN_SAMPLES,
+    WCB_AGG,
+    WCB_START_EPOCH,
+};
+
+#define WCB_AGG_BITS 2
+
+// Claves del sobre de captura cruda (no se mezclan con las de ventana)
+#define WCB_CAP_ID    32
+#define WCB_CAP_SEQ   33
+#define WCB_CAP_BLOCK 34
+
+#define CBOR_MAJOR_UINT  0
+#define CBOR_MAJOR_NINT  1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT  3
+#define CBOR_MAJOR_MAP   5
+
+// ---------- Escritura ----------
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} cbor_writer_t;
+
+static void cbor_put_bytes(cbor_writer_t *w, const void *data, size_t n) {
+    if (w->overflow || w->len + n > w->cap) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, n);
+    w->len += n;
+}
+
+static void cbor_put_head(cbor_writer_t *w, uint8_t major, uint64_t val) {
+    uint8_t h[9];
+    size_t n;
+    if (val < 24) {
+        h[0] = (uint8_t)((major << 5) | val);
+        n = 1;
+    } else if (val <= 0xFF) {
+        h[0] = (uint8_t)((major << 5) | 24);
+        h[1] = (uint8_t)val;
+        n = 2;
+    } else if (val <= 0xFFFF) {
+        h[0] = (uint8_t)((major << 5) | 25);
+        h[1] = (uint8_t)(val >> 8);
+        h[2] = (uint8_t)val;
+        n = 3;
+    } else if (val <= 0xFFFFFFFFu) {
+        h[0] = (uint8_t)((major << 5) | 26);
+        for (int i = 0; i < 4; ++i) h[1 + i] = (uint8_t)(val >> (24 - 8 * i));
+        n = 5;
+    } else {
+        h[0] = (uint8_t)((major << 5) | 27);
+        for (int i = 0; i < 8; ++i) h[1 + i] = (uint8_t)(val >> (56 - 8 * i));
+        n = 9;
+    }
+    cbor_put_bytes(w, h, n);
+}
+
+static void cbor_put_int(cbor_writer_t *w, int64_t v) {
+    if (v >= 0) cbor_put_head(w, CBOR_MAJOR_UINT, (uint64_t)v);
+    else        cbor_put_head(w, CBOR_MAJOR_NINT, (uint64_t)(-1 - v));
+}
+
+static void cbor_put_text(cbor_writer_t *w, const char *s) {
+    size_t n = strlen(s);
+    cbor_put_head(w, CBOR_MAJOR_TEXT, n);
+    cbor_put_bytes(w, s, n);
+}
+
+static int64_t scaled(float v, int mult) {
+    return (int64_t)lroundf(v * (float)mult);
+}
+
+size_t window_cbor_encode(const window_record_t *w,
+                          const char *device_id,
+                          const window_cbor_extra_t *extra,
+                          uint8_t *buf, size_t cap) {
+    if (!w || !buf || cap == 0) return 0;
+
+    bool has_dev    = device_id && device_id[0];
+    bool has_ver    = extra && extra->ver && extra->ver[0];
+    bool has_ciudad = extra && extra->ciudad && extra->ciudad[0];
+    bool has_inicio = extra && extra->inicio_epoch != 0;
+
+    uint32_t agg_bits = 0;
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        agg_bits |= (uint32_t)(w->agg[f] & 0x03) << (f * WCB_AGG_BITS);
+    }
+    bool has_agg = agg_bits != 0;
+
+    const SensorData *a = &w->avg;
+    cbor_writer_t cw = { .buf = buf, .cap = cap };
+
+    cbor_put_head(&cw, CBOR_MAJOR_MAP, 15 + has_dev + has_ver + has_ciudad + has_inicio + has_agg);
+    if (has_dev) {
+        cbor_put_int(&cw, WCB_DEVICE_ID);  cbor_put_text(&cw, device_id);
+    }
+    cbor_put_int(&cw, WCB_END_EPOCH);   cbor_put_int(&cw, w->end_epoch);
+    cbor_put_int(&cw, WCB_START_EPOCH); cbor_put_int(&cw, w->start_epoch);
+    cbor_put_int(&cw, WCB_CO2);         cbor_put_int(&cw, a->co2);
+    cbor_put_int(&cw, WCB_PM1P0);       cbor_put_int(&cw, scaled(a->pm1p0, 100));
+    cbor_put_int(&cw, WCB_PM2P5);       cbor_put_int(&cw, scaled(a->pm2p5, 100));
+    cbor_put_int(&cw, WCB_PM4P0);       cbor_put_int(&cw, scaled(a->pm4p0, 100));
+    cbor_put_int(&cw, WCB_PM10P0);      cbor_put_int(&cw, scaled(a->pm10p0, 100));
+    cbor_put_int(&cw, WCB_VOC);         cbor_put_int(&cw, scaled(a->voc, 10));
+    cbor_put_int(&cw, WCB_NOX);         cbor_put_int(&cw, scaled(a->nox, 10));
+    cbor_put_int(&cw, WCB_CTE);         cbor_put_int(&cw, scaled(a->avg_temp, 100));
+    cbor_put_int(&cw, WCB_CHU);         cbor_put_int(&cw, scaled(a->avg_hum, 100));
+    cbor_put_int(&cw, WCB_SEN_TEMP);    cbor_put_int(&cw, scaled(a->sen_temp, 100));
+    cbor_put_int(&cw, WCB_SEN_HUM);     cbor_put_int(&cw, scaled(a->sen_hum, 100));
+    if (has_ver) {
+        cbor_put_int(&cw, WCB_VER);     cbor_put_text(&cw, extra->ver);
+    }
+    if (has_ciudad) {
+        cbor_put_int(&cw, WCB_CIUDAD);  cbor_put_text(&cw, extra->ciudad);
+    }
+    if (has_inicio) {
+        cbor_put_int(&cw, WCB_INICIO);  cbor_put_int(&cw, extra->inicio_epoch);
+    }
+    cbor_put_int(&cw, WCB_SCD_SAMPLES); cbor_put_int(&cw, w->scd_samples);
+    cbor_put_int(&cw, WCB_SEN_SAMPLES); cbor_put_int(&cw, w->sen_samples);
+    if (has_agg) {
+        cbor_put_int(&cw, WCB_AGG);     cbor_put_int(&cw, agg_bits);
+    }
+
+    return cw.overflow ? 0 : cw.len;
+}
+
+size_t window_cbor_encode_capture(const char *device_id, uint32_t capture_id, uint16_t seq,
+                                  const uint8_t *block, size_t block_len,
+                                  uint8_t *buf, size_t cap) {
+    if (!block || !buf || cap == 0) return 0;
+
+    bool has_dev = device_id && device_id[0];
+    cbor_writer_t cw = { .buf = buf, .cap = cap };
+
+    cbor_put_head(&cw, CBOR_MAJOR_MAP, 3 + has_dev);
+    if (has_dev) {
+        cbor_put_int(&cw, WCB_DEVICE_ID);  cbor_put_text(&cw, device_id);
+    }
+    cbor_put_int(&cw, WCB_CAP_ID);      cbor_put_int(&cw, capture_id);
+    cbor_put_int(&cw, WCB_CAP_SEQ);     cbor_put_int(&cw, seq);
+    cbor_put_int(&cw, WCB_CAP_BLOCK);
+    cbor_put_head(&cw, CBOR_MAJOR_BYTES, block_len);
+    cbor_put_bytes(&cw, block, block_len);
+
+    return cw.overflow ? 0 : cw.len;
+}
+
+// ---------- Lectura ----------
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} cbor_reader_t;
+
+static bool cbor_get_head(cbor_reader_t *r, uint8_t *major, uint64_t *val) {
+    if (r->p >= r->end) return false;
+    uint8_t b = *r->p++;
+    uint8_t ai = b & 0x1F;
+    *major = b >> 5;
+
+    size_t n;
+    if (ai < 24)       { *val = ai; return true; }
+    else if (ai == 24) n = 1;
+    else if (ai == 25) n = 2;
+    else if (ai == 26) n = 4;
+    else if (ai == 27) n = 8;
+    else return false;   // largos indefinidos / reservados: fuera del esquema
+
+    if ((size_t)(r->end - r->p) < n) return false;
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; ++i) v = (v << 8) | *r->p++;
+    *val = v;
+    return true;
+}
+
+static bool cbor_get_int(cbor_reader_t *r, int64_t *out) {
+    uint8_t major;
+    uint64_t val;
+    if (!cbor_get_head(r, &major, &val) || val > INT64_MAX) return false;
+    if (major == CBOR_MAJOR_UINT) { *out = (int64_t)val; return true; }
+    if (major == CBOR_MAJOR_NINT) { *out = -1 - (int64_t)val; return true; }
+    return false;
+}
+
+// Texto a dst (truncado a cap-1). dst NULL = solo saltar.
+static bool cbor_get_text(cbor_reader_t *r, char *dst, size_t cap) {
+    uint8_t major;
+    uint64_t n;
+    if (!cbor_get_head(r, &major, &n) || major != CBOR_MAJOR_TEXT) return false;
+    if ((uint64_t)(r->end - r->p) < n) return false;
+    if (dst && cap > 0) {
+        size_t c = n < cap - 1 ? (size_t)n : cap - 1;
+        memcpy(dst, r->p, c);
+        dst[c] = '\0';
+    }
+    r->p += n;
+    return true;
+}
+
+// Salta un valor escalar (entero, texto o bytes)
+static bool cbor_skip(cbor_reader_t *r) {
+    const uint8_t *save = r->p;
+    uint8_t major;
+    uint64_t val;
+    if (!cbor_get_head(r, &major, &val)) return false;
+    if (major == CBOR_MAJOR_UINT || major == CBOR_MAJOR_NINT) return true;
+    if (major == CBOR_MAJOR_TEXT || major == CBOR_MAJOR_BYTES) {
+        if ((uint64_t)(r->end - r->p) < val) { r->p = save; return false; }
+        r->p += val;
+        return true;
+    }
+    return false;
+}
+
+esp_err_t window_cbor_decode(const uint8_t *buf, size_t len,
+                             window_record_t *out,
+                             window_cbor_meta_t *meta) {
+    if (!buf || !out) return ESP_ERR_INVALID_ARG;
+
+    memset(out, 0, sizeof(*out));
+    if (meta) memset(meta, 0, sizeof(*meta));
+
+    cbor_reader_t r = { .p = buf, .end = buf + len };
+    uint8_t major;
+    uint64_t pairs;
+    if (!cbor_get_head(&r, &major, &pairs) || major != CBOR_MAJOR_MAP) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    SensorData *a = &out->avg;
+    for (uint64_t i = 0; i < pairs; ++i) {
+        int64_t key, v = 0;
+        if (!cbor_get_int(&r, &key)) return ESP_ERR_INVALID_RESPONSE;
+
+        bool ok;
+        switch (key) {
+        case WCB_DEVICE_ID:
+            ok = cbor_get_text(&r, meta ? meta->device_id : NULL, meta ? sizeof(meta->device_id) : 0);
+            break;
+        case WCB_VER:
+            ok = cbor_get_text(&r, meta ? meta->ver : NULL, meta ? sizeof(meta->ver) : 0);
+            break;
+        case WCB_CIUDAD:
+            ok = cbor_get_text(&r, meta ? meta->ciudad : NULL, meta ? sizeof(meta->ciudad) : 0);
+            break;
+        default:
+            if (key < WCB_DEVICE_ID || key > WCB_START_EPOCH) {
+                ok = cbor_skip(&r);
+                break;
+            }
+            ok = cbor_get_int(&r, &v);
+            break;
+        }
+        if (!ok) return ESP_ERR_INVALID_RESPONSE;
+
+        switch (key) {
+        case WCB_END_EPOCH:   out->end_epoch = (uint32_t)v; break;
+        case WCB_START_EPOCH: out->start_epoch = (uint32_t)v; break;
+        case WCB_CO2:         a->co2 = (uint16_t)v; break;
+        case WCB_PM1P0:       a->pm1p0 = v / 100.0f; break;
+        case WCB_PM2P5:       a->pm2p5 = v / 100.0f; break;
+        case WCB_PM4P0:       a->pm4p0 = v / 100.0f; break;
+        case WCB_PM10P0:      a->pm10p0 = v / 100.0f; break;
+        case WCB_VOC:         a->voc = v / 10.0f; break;
+        case WCB_NOX:         a->nox = v / 10.0f; break;
+        case WCB_CTE:         a->avg_temp = v / 100.0f; break;
+        case WCB_CHU:         a->avg_hum = v / 100.0f; break;
+        case WCB_SEN_TEMP:    a->sen_temp = v / 100.0f; break;
+        case WCB_SEN_HUM:     a->sen_hum = v / 100.0f; break;
+        case WCB_INICIO:      if (meta) meta->inicio_epoch = (uint32_t)v; break;
+        case WCB_SCD_SAMPLES: out->scd_samples = (uint16_t)v; break;
+        case WCB_SEN_SAMPLES: out->sen_samples = (uint16_t)v; break;
+        case WCB_AGG:
+            for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+                out->agg[f] = (uint8_t)(((uint64_t)v >> (f * WCB_AGG_BITS)) & 0x03);
+            }
+            break;
+        default: break;
+        }
+    }
+
+    // Igual que el promedio de main: scd_* reflejan el promedio combinado
+    a->scd_temp = a->avg_temp;
+    a->scd_hum  = a->avg_hum;
+    return r.p == r.end ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
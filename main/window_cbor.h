@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "window.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Codificación CBOR (RFC 8949) compacta de una ventana, alternativa al JSON
+// de ingest. Se envía con Content-Type WINDOW_CBOR_CONTENT_TYPE.
+//
+// Es un mapa con claves enteras; los valores de medición van como enteros
+// escalados a la misma precisión que el JSON (x100 para %.2f, x10 para %.1f),
+// así el dispositivo no formatea floats y el servidor no parsea texto.
+//
+//   0 device_id (texto)        7 voc x10           13 ver (texto, opcional)
+//   1 fin de ventana (epoch)   8 nox x10           14 ciudad (texto, opcional)
+//   2 co2 ppm                  9 cTe x100          15 inicio (epoch, opcional)
+//   3 pm1p0 x100              10 cHu x100          16 muestras SCD40
+//   4 pm2p5 x100              11 sen55_temp_dbg x100
+//   5 pm4p0 x100              12 sen55_hum_dbg x100
+//   6 pm10p0 x100                                  17 muestras SEN55
+//                                                  18 agregadores (opcional)
+//                                                  19 inicio de ventana (epoch)
+//
+// La clave 18 solo va si algún campo no es media: 2 bits por campo
+// (window_agg_t) en el orden de sensor_field_t, campo 0 en los bits bajos.
+
+#define WINDOW_CBOR_CONTENT_TYPE "application/cbor"
+#define WINDOW_CBOR_MAX_LEN      256
+#define WINDOW_CBOR_CAPTURE_CONTENT_TYPE "application/x-raw-capture+cbor"
+
+// Campos de contexto opcionales (NULL / 0 = se omiten)
+typedef struct {
+    const char *ver;
+    const char *ciudad;
+    uint32_t    inicio_epoch;
+} window_cbor_extra_t;
+
+// Lo que devuelve el decodificador además de la ventana
+typedef struct {
+    char     device_id[48];
+    char     ver[32];
+    char     ciudad[64];
+    uint32_t inicio_epoch;
+} window_cbor_meta_t;
+
+// Devuelve bytes escritos, o 0 si no cabe en cap.
+size_t window_cbor_encode(const window_record_t *w,
+                          const char *device_id,
+                          const window_cbor_extra_t *extra,
+                          uint8_t *buf, size_t cap);
+
+// Sobre de un bloque de captura cruda (raw_capture), stream aparte de las
+// ventanas con Content-Type WINDOW_CBOR_CAPTURE_CONTENT_TYPE:
+//
+//   0 device_id (texto)   32 id de captura (epoch de inicio)
+//   33 nº de bloque       34 bloque ts_codec (bytes)
+//
+// El servidor arma la serie concatenando los bloques de un mismo id en
+// orden de la clave 33; cada bloque se decodifica solo (ts_dec_*).
+size_t window_cbor_encode_capture(const char *device_id, uint32_t capture_id, uint16_t seq,
+                                  const uint8_t *block, size_t block_len,
+                                  uint8_t *buf, size_t cap);
+
+// Decodificador de referencia (mismo esquema). meta puede ser NULL.
+// Claves desconocidas se ignoran.
+esp_err_t window_cbor_decode(const uint8_t *buf, size_t len,
+                             window_record_t *out,
+                             window_cbor_meta_t *meta);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+// fixed_fmt_float contra snprintf("%.2f") con valores típicos de ventana
+#include <stdio.h>
+
+#include "fixed_fmt.h"
+#include "host_bench.h"
+
+#define ROUNDS 3000000
+
+int main(void) {
+    char buf[32];
+
+    double t0 = host_bench_now_s();
+    for (int i = 0; i < ROUNDS; ++i) {
+        g_host_bench_sink += (uint32_t)snprintf(buf, sizeof(buf), "%.2f", (double)((float)(i % 100000) * 0.37f));
+    }
+    double t_printf = host_bench_now_s() - t0;
+
+    t0 = host_bench_now_s();
+    for (int i = 0; i < ROUNDS; ++i) {
+        g_host_bench_sink += (uint32_t)fixed_fmt_float(buf, sizeof(buf), (float)(i % 100000) * 0.37f, 2);
+    }
+    double t_fixed = host_bench_now_s() - t0;
+
+    printf("snprintf:  %.1f ns/valor\n", t_printf * 1e9 / ROUNDS);
+    printf("fixed_fmt: %.1f ns/valor (x%.1f)\n", t_fixed * 1e9 / ROUNDS, t_printf / t_fixed);
+    return 0;
+}
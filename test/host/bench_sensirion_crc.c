@@ -0,0 +1,35 @@
+// CRC8 por tabla contra bit a bit: validación de una trama SEN5x (8 palabras)
+#include <stdio.h>
+
+#include "crc_ref.h"
+#include "host_bench.h"
+#include "sensirion_crc.h"
+
+#define ROUNDS 2000000
+
+int main(void) {
+    uint8_t frame[24];
+    for (int i = 0; i < 8; ++i) {
+        frame[3 * i] = (uint8_t)(0x10 + i);
+        frame[3 * i + 1] = (uint8_t)(0x80 + 3 * i);
+        frame[3 * i + 2] = crc8_ref_word(&frame[3 * i]);
+    }
+
+    double t0 = host_bench_now_s();
+    for (int r = 0; r < ROUNDS; ++r) {
+        frame[1] = (uint8_t)r;
+        for (int i = 0; i < 8; ++i) g_host_bench_sink += crc8_ref_word(&frame[3 * i]);
+    }
+    double t_ref = host_bench_now_s() - t0;
+
+    t0 = host_bench_now_s();
+    for (int r = 0; r < ROUNDS; ++r) {
+        frame[1] = (uint8_t)r;
+        for (int i = 0; i < 8; ++i) g_host_bench_sink += sensirion_crc8_word(&frame[3 * i]);
+    }
+    double t_tab = host_bench_now_s() - t0;
+
+    printf("bit a bit: %.1f ns/trama\n", t_ref * 1e9 / ROUNDS);
+    printf("tabla:     %.1f ns/trama (x%.1f)\n", t_tab * 1e9 / ROUNDS, t_ref / t_tab);
+    return 0;
+}
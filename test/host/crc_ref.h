@@ -0,0 +1,14 @@
+#pragma once
+// CRC8 Sensirion bit a bit (la forma del datasheet), referencia de las pruebas
+#include <stdint.h>
+
+static inline uint8_t crc8_ref_word(const uint8_t *w) {
+    uint8_t crc = 0xFF;
+    for (int i = 0; i < 2; ++i) {
+        crc ^= w[i];
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,13 @@
+#pragma once
+// Cronómetro de los benchmarks de host (no son pruebas: ctest no los corre)
+#include <stdint.h>
+#include <time.h>
+
+static inline double host_bench_now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Evita que el compilador descarte el resultado medido
+static volatile uint32_t g_host_bench_sink;
@@ -0,0 +1,22 @@
+#pragma once
+// Mini framework de las pruebas de host: CHECK cuenta fallas y sigue,
+// host_test_result() da el código de salida para ctest.
+#include <stdio.h>
+
+static int s_host_test_failures;
+
+#define CHECK(cond) do {                                                   \
+        if (!(cond)) {                                                     \
+            fprintf(stderr, "%s:%d: falla: %s\n", __FILE__, __LINE__, #cond); \
+            s_host_test_failures++;                                        \
+        }                                                                  \
+    } while (0)
+
+static inline int host_test_result(const char *name) {
+    if (s_host_test_failures) {
+        fprintf(stderr, "%s: %d fallas\n", name, s_host_test_failures);
+        return 1;
+    }
+    printf("%s: OK\n", name);
+    return 0;
+}
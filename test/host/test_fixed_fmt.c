@@ -0,0 +1,82 @@
+// fixed_fmt_float contra snprintf("%.*f") en los rangos de los sensores
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fixed_fmt.h"
+#include "host_test.h"
+
+static long s_checked;
+static long s_mismatches;
+
+static void check_one(float v, int decimals) {
+    char expect[64], got[64];
+    snprintf(expect, sizeof(expect), "%.*f", decimals, (double)v);
+    int n = fixed_fmt_float(got, sizeof(got), v, decimals);
+    s_checked++;
+    if (n != (int)strlen(expect) || strcmp(expect, got) != 0) {
+        if (s_mismatches++ < 10) {
+            fprintf(stderr, "%.9g decimales=%d: snprintf=%s fixed=%s\n", (double)v, decimals, expect, got);
+        }
+    }
+}
+
+// Valores crudos de los sensores: todas las palabras de 16 bits con la
+// escala de cada campo (PM/VOC/NOx /10, humedad /100, temperatura /200, CO2)
+static void test_sensor_ticks(void) {
+    for (uint32_t t = 0; t <= 0xFFFF; ++t) {
+        for (int d = 0; d <= 3; ++d) {
+            check_one((float)t / 10.0f, d);
+            check_one((float)t / 100.0f, d);
+            check_one((float)t / 200.0f, d);
+            check_one(-(float)t / 200.0f, d);
+            check_one((float)t, d);
+        }
+    }
+}
+
+// Promedios de ventana: cualquier float en [0, 70000], recorrido por bits
+// con paso primo (todas las magnitudes y patrones de mantisa)
+static void test_window_averages(void) {
+    const uint32_t top = 0x4788B800;    // 70000.0f
+    for (uint32_t bits = 0; bits <= top; bits += 211) {
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        check_one(v, 2);
+        check_one(v, 1);
+        check_one(-v, 2);
+    }
+}
+
+// Empates exactos en binario: redondeo a par como printf
+static void test_ties_and_edges(void) {
+    const float cases[] = { 0.125f, 0.375f, 2.5f, 3.5f, 0.5f, 1.5f, -0.0f, -0.001f,
+                            -0.004f, 999.995f, 1e12f, 1e30f, 16777216.0f };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        for (int d = 0; d <= FIXED_FMT_MAX_DECIMALS + 1; ++d) {
+            check_one(cases[i], d);
+        }
+    }
+    check_one(NAN, 2);
+    check_one(INFINITY, 2);
+    check_one(-INFINITY, 1);
+}
+
+static void test_short_buffer(void) {
+    char buf[6];
+    CHECK(fixed_fmt_float(buf, sizeof(buf), 12.34f, 2) == 5);
+    CHECK(strcmp(buf, "12.34") == 0);
+    CHECK(fixed_fmt_float(buf, sizeof(buf), 123.45f, 2) == -1);
+    CHECK(fixed_fmt_float(buf, 0, 1.0f, 2) == -1);
+}
+
+int main(void) {
+    test_sensor_ticks();
+    test_window_averages();
+    test_ties_and_edges();
+    test_short_buffer();
+    CHECK(s_mismatches == 0);
+    printf("%ld valores comparados, %ld diferencias\n", s_checked, s_mismatches);
+    return host_test_result("test_fixed_fmt");
+}
@@ -0,0 +1,82 @@
+// Agregadores robustos: mediana, media recortada y Hampel
+#include <math.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "robust_agg.h"
+
+#define NEAR(a, b) (fabsf((a) - (b)) < 1e-4f)
+
+static void test_median(void) {
+    float odd[] = { 5, 1, 4, 2, 3 };
+    CHECK(NEAR(robust_median(odd, 5), 3.0f));
+    float even[] = { 4, 1, 3, 2 };
+    CHECK(NEAR(robust_median(even, 4), 2.5f));
+    float one[] = { 7 };
+    CHECK(NEAR(robust_median(one, 1), 7.0f));
+    CHECK(robust_median(one, 0) == 0.0f);
+}
+
+static void test_trimmed(void) {
+    // 10 muestras, 10%: fuera el 1 y el 100
+    float v[] = { 100, 5, 5, 5, 5, 5, 5, 5, 5, 1 };
+    CHECK(NEAR(robust_trimmed_mean(v, 10, 0.10f), 5.0f));
+}
+
+static void test_hampel_spike(void) {
+    float v[] = { 10.1f, 10.2f, 10.0f, 10.1f, 10.3f, 10.2f, 10.1f, 10.0f, 10.2f, 85.0f };
+    float scratch[10];
+    size_t rejected = 0;
+    float m = robust_hampel_mean(v, scratch, 10, ROBUST_HAMPEL_K, 0.1f, &rejected);
+    CHECK(rejected == 1);
+    CHECK(NEAR(m, (10.1f + 10.2f + 10.0f + 10.1f + 10.3f + 10.2f + 10.1f + 10.0f + 10.2f) / 9));
+}
+
+// Ventana plana de aire limpio (PM cuantizado a 0.1): MAD = 0
+static void test_hampel_flat_window(void) {
+    float v[] = { 1.2f, 1.2f, 1.2f, 1.2f, 1.2f, 1.2f, 1.3f, 1.4f, 1.3f, 1.1f };
+    float scratch[10];
+    size_t rejected = 0;
+    float m = robust_hampel_mean(v, scratch, 10, ROBUST_HAMPEL_K, 0.1f, &rejected);
+    CHECK(rejected == 0);
+    CHECK(NEAR(m, 1.23f));
+
+    // Sin piso de MAD se descartaba todo lo distinto de la mediana
+    float w[] = { 1.2f, 1.2f, 1.2f, 1.2f, 1.2f, 1.2f, 1.3f, 1.4f, 1.3f, 1.1f };
+    robust_hampel_mean(w, scratch, 10, ROBUST_HAMPEL_K, 0.0f, &rejected);
+    CHECK(rejected == 4);
+
+    // Un pico real sigue afuera aunque la ventana sea plana
+    float p[] = { 1.2f, 1.2f, 1.2f, 1.2f, 1.2f, 1.2f, 1.3f, 1.4f, 1.3f, 40.0f };
+    robust_hampel_mean(p, scratch, 10, ROBUST_HAMPEL_K, 0.1f, &rejected);
+    CHECK(rejected == 1);
+}
+
+static int cmp_float(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Mediana por selección contra qsort en arreglos aleatorios con repetidos
+static void test_median_random(void) {
+    srand(7);
+    for (int iter = 0; iter < 2000; ++iter) {
+        size_t n = 1 + (size_t)(rand() % 64);
+        float v[64], s[64];
+        for (size_t i = 0; i < n; ++i) {
+            v[i] = s[i] = (float)(rand() % 50) / 10.0f;
+        }
+        qsort(s, n, sizeof(float), cmp_float);
+        float expect = (n & 1) ? s[n / 2] : (s[n / 2 - 1] + s[n / 2]) / 2.0f;
+        CHECK(NEAR(robust_median(v, n), expect));
+    }
+}
+
+int main(void) {
+    test_median();
+    test_trimmed();
+    test_hampel_spike();
+    test_hampel_flat_window();
+    test_median_random();
+    return host_test_result("test_robust_agg");
+}
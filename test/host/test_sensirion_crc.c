@@ -0,0 +1,45 @@
+// CRC8 por tabla contra el bit a bit en las 65536 palabras posibles
+#include "crc_ref.h"
+#include "host_test.h"
+#include "sensirion_crc.h"
+
+static void test_exhaustive(void) {
+    int mismatches = 0;
+    for (uint32_t v = 0; v <= 0xFFFF; ++v) {
+        uint8_t w[2] = { (uint8_t)(v >> 8), (uint8_t)v };
+        if (sensirion_crc8_word(w) != crc8_ref_word(w)) mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
+
+static void test_datasheet_vector(void) {
+    const uint8_t w[2] = { 0xBE, 0xEF };
+    CHECK(sensirion_crc8_word(w) == 0x92);
+}
+
+static void test_check_words(void) {
+    uint8_t frame[3 * 4];
+    const uint16_t words[4] = { 0xBEEF, 0x0000, 0x1234, 0xFFFF };
+    for (int i = 0; i < 4; ++i) {
+        frame[3 * i] = (uint8_t)(words[i] >> 8);
+        frame[3 * i + 1] = (uint8_t)words[i];
+        frame[3 * i + 2] = crc8_ref_word(&frame[3 * i]);
+    }
+
+    uint16_t out[4] = { 0 };
+    CHECK(sensirion_check_words(frame, 4, out) == -1);
+    for (int i = 0; i < 4; ++i) CHECK(out[i] == words[i]);
+    CHECK(sensirion_check_words(frame, 4, NULL) == -1);
+
+    // Un bit dañado en la tercera palabra: índice 2
+    frame[3 * 2 + 1] ^= 0x04;
+    CHECK(sensirion_check_words(frame, 4, out) == 2);
+    CHECK(sensirion_check_words(frame, 2, NULL) == -1);
+}
+
+int main(void) {
+    test_exhaustive();
+    test_datasheet_vector();
+    test_check_words();
+    return host_test_result("test_sensirion_crc");
+}
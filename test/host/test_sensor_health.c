@@ -0,0 +1,90 @@
+// Salud por sensor: escalones, backoff y el sensor que falla al arrancar
+#include "host_test.h"
+#include "sensor_health.h"
+#include "sensors.h"
+
+#define S(x) ((int64_t)(x) * 1000000)
+
+static void fail_n(sensor_health_t *h, int n, int diag, int64_t now_us, sensor_recover_t *last) {
+    for (int i = 0; i < n; ++i) {
+        *last = sensor_health_report(h, false, diag, now_us);
+    }
+}
+
+static void test_escalation(void) {
+    sensor_health_t h;
+    sensor_health_init(&h);
+    sensor_recover_t a;
+
+    fail_n(&h, SENSOR_HEALTH_FAILS_PER_STEP - 1, SENSOR_DIAG_TIMEOUT, 0, &a);
+    CHECK(a == SENSOR_RECOVER_NONE);
+    CHECK(h.state == SENSOR_HEALTH_RETRY);
+    CHECK(sensor_health_active(&h, 0));
+
+    fail_n(&h, 1, SENSOR_DIAG_TIMEOUT, 0, &a);
+    CHECK(a == SENSOR_RECOVER_SOFT_RESET);
+    CHECK(!sensor_health_active(&h, 0));
+    CHECK(sensor_health_active(&h, S(SENSOR_HEALTH_BACKOFF_MIN_MS / 1000)));
+
+    fail_n(&h, SENSOR_HEALTH_FAILS_PER_STEP, SENSOR_DIAG_CRC, S(10), &a);
+    CHECK(a == SENSOR_RECOVER_BUS);
+    fail_n(&h, SENSOR_HEALTH_FAILS_PER_STEP, SENSOR_DIAG_I2C_RX, S(40), &a);
+    CHECK(a == SENSOR_RECOVER_READD);
+    fail_n(&h, SENSOR_HEALTH_FAILS_PER_STEP, SENSOR_DIAG_I2C_RX, S(100), &a);
+    CHECK(a == SENSOR_RECOVER_READD);
+    CHECK(h.readds == 2);
+
+    CHECK(sensor_health_report(&h, true, SENSOR_DIAG_OK, S(200)) == SENSOR_RECOVER_NONE);
+    CHECK(h.state == SENSOR_HEALTH_OK);
+    CHECK(h.recoveries == 1);
+    CHECK(h.backoff_ms == 0);
+}
+
+// Fuera de rango: el sensor responde, no escala
+static void test_out_of_range(void) {
+    sensor_health_t h;
+    sensor_health_init(&h);
+    sensor_recover_t a;
+    fail_n(&h, 10, SENSOR_DIAG_OUT_OF_RANGE, 0, &a);
+    CHECK(a == SENSOR_RECOVER_NONE);
+    CHECK(h.state == SENSOR_HEALTH_OK);
+    CHECK(h.reads_failed == 10);
+}
+
+// Falla al arrancar (no ausente): READD con backoff, re-agregados que
+// fallan lo alargan hasta el tope, y la primera lectura buena lo recupera
+static void test_detached_at_boot(void) {
+    sensor_health_t h;
+    sensor_health_init_detached(&h, SENSOR_DIAG_TIMEOUT, S(100));
+    CHECK(h.state == SENSOR_HEALTH_READD);
+    CHECK(h.last_diag == SENSOR_DIAG_TIMEOUT);
+    CHECK(h.backoff_ms == SENSOR_HEALTH_BACKOFF_MIN_MS);
+    CHECK(h.readds == 0);
+    CHECK(!sensor_health_active(&h, S(100)));
+    CHECK(sensor_health_active(&h, S(100) + (int64_t)SENSOR_HEALTH_BACKOFF_MIN_MS * 1000));
+
+    int64_t now = S(110);
+    for (int i = 0; i < 20; ++i) {
+        CHECK(sensor_health_active(&h, now));
+        sensor_health_readd_attempt(&h, now);
+        CHECK(!sensor_health_active(&h, now));
+        now = h.resume_us;
+    }
+    CHECK(h.readds == 20);
+    CHECK(h.backoff_ms == SENSOR_HEALTH_BACKOFF_MAX_MS);
+    CHECK(h.state == SENSOR_HEALTH_READD);
+
+    // Volvió al bus: la primera lectura buena lo deja en OK
+    CHECK(sensor_health_report(&h, true, SENSOR_DIAG_OK, now) == SENSOR_RECOVER_NONE);
+    CHECK(h.state == SENSOR_HEALTH_OK);
+    CHECK(h.recoveries == 1);
+    CHECK(h.reads_ok == 1);
+    CHECK(sensor_health_active(&h, now));
+}
+
+int main(void) {
+    test_escalation();
+    test_out_of_range();
+    test_detached_at_boot();
+    return host_test_result("test_sensor_health");
+}
@@ -0,0 +1,214 @@
+// Ida y vuelta ts_enc -> ts_dec, incluidos NaN, saltos grandes y desborde
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "ts_codec.h"
+
+#define ALL_FIELDS ((1u << SENSOR_FIELD_COUNT) - 1)
+#define FLAGS_BOTH (SENSOR_FIELD_SRC_SCD | SENSOR_FIELD_SRC_SEN)
+
+static float step_of(int f) {
+    static const float steps[] = { 1.0f, 0.1f, 0.01f, 0.001f };
+    return steps[g_sensor_fields[f].decimals];
+}
+
+// Mismo valor tras cuantizar a los decimales del campo (NaN con NaN)
+static int same_value(int f, float in, float out) {
+    if (isnan(in)) return isnan(out);
+    return fabsf(in - out) <= step_of(f) / 2 * 1.001f + fabsf(in) * 1e-6f;
+}
+
+static void test_random_series(void) {
+    static uint8_t buf[8192];
+    static SensorData in[500];
+    static uint32_t ts[500];
+    static uint8_t fl[500];
+    ts_enc_t e;
+    CHECK(ts_enc_init(&e, buf, sizeof(buf), ALL_FIELDS, 1760000000u) == ESP_OK);
+
+    srand(1);
+    uint32_t t = 1234;
+    int n = 0;
+    for (; n < 500; ++n) {
+        SensorData d = {0};
+        d.co2 = (uint16_t)(600 + rand() % 20);
+        d.pm1p0 = roundf((5 + sinf(n / 10.0f) * 2) * 10) / 10;
+        d.pm2p5 = d.pm1p0 + 1.1f;
+        d.pm4p0 = d.pm2p5 + 0.3f;
+        d.pm10p0 = d.pm4p0 + 0.2f;
+        d.voc = (float)(100 + rand() % 5);
+        d.nox = 1.0f;
+        d.sen_temp = roundf((22 + n * 0.001f) * 200) / 200;
+        d.sen_hum = roundf((45 + sinf(n / 30.0f)) * 100) / 100;
+        d.avg_temp = d.sen_temp;
+        d.avg_hum = d.sen_hum;
+        uint8_t f = (n % 7 == 3) ? SENSOR_FIELD_SRC_SEN : FLAGS_BOTH;
+        t += 5000 + (uint32_t)(rand() % 21) - 10;
+        if (ts_enc_add(&e, t, f, &d) != ESP_OK) break;
+        in[n] = d;
+        ts[n] = t;
+        fl[n] = f;
+    }
+    CHECK(n == 500);
+    size_t len = ts_enc_finish(&e);
+    CHECK(len < (size_t)n * 16);   // cadencia fija, valores suaves
+
+    ts_dec_t dec;
+    CHECK(ts_dec_init(&dec, buf, len) == ESP_OK);
+    CHECK(dec.base_epoch == 1760000000u && dec.count == n);
+    SensorData out = {0};
+    uint32_t t_ms;
+    uint8_t flags;
+    int k = 0;
+    uint16_t last_co2 = 0;
+    while (ts_dec_next(&dec, &t_ms, &flags, &out) == ESP_OK) {
+        CHECK(t_ms == ts[k] && flags == fl[k]);
+        if (flags & SENSOR_FIELD_SRC_SCD) last_co2 = in[k].co2;
+        CHECK(out.co2 == last_co2);     // sin SCD queda el último valor
+        for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+            if (f == SENSOR_FIELD_CO2) continue;
+            CHECK(same_value(f, sensor_field_get(&in[k], f), sensor_field_get(&out, f)));
+        }
+        k++;
+    }
+    CHECK(k == n);
+}
+
+// Valores que no entran en un delta de 32 bits, NaN y saturación
+static void test_extremes(void) {
+    const float series[] = { -1.5e7f, 1.5e7f, 3.0f, NAN, 2.0f, NAN, NAN, -0.5f,
+                             1e30f, -1e30f, 0.0f, INFINITY, 7.25f };
+    const int n = (int)(sizeof(series) / sizeof(series[0]));
+    uint8_t buf[1024];
+    ts_enc_t e;
+    ts_enc_init(&e, buf, sizeof(buf), 1u << SENSOR_FIELD_PM2P5, 0);
+    // Tiempos con saltos que no entran en 32 bits como delta del delta
+    const uint32_t ts[] = { 0, 4000000000u, 4000000001u, 4000000001u, 4100000000u, 4100000000u,
+                            4294967295u, 4294967295u, 4294967295u, 4294967295u, 4294967295u,
+                            4294967295u, 4294967295u };
+    for (int i = 0; i < n; ++i) {
+        SensorData d = {0};
+        d.pm2p5 = series[i];
+        CHECK(ts_enc_add(&e, ts[i], SENSOR_FIELD_SRC_SEN, &d) == ESP_OK);
+    }
+    size_t len = ts_enc_finish(&e);
+
+    ts_dec_t dec;
+    CHECK(ts_dec_init(&dec, buf, len) == ESP_OK);
+    SensorData out = {0};
+    uint32_t t_ms;
+    for (int i = 0; i < n; ++i) {
+        CHECK(ts_dec_next(&dec, &t_ms, NULL, &out) == ESP_OK);
+        CHECK(t_ms == ts[i]);
+        float v = series[i];
+        if (isinf(v) || fabsf(v) > 2e7f) {
+            // Saturado al entero de 32 bits escalado
+            CHECK(fabsf(out.pm2p5) > 2.1e7f && (out.pm2p5 > 0) == (v > 0));
+        } else {
+            CHECK(same_value(SENSOR_FIELD_PM2P5, v, out.pm2p5));
+        }
+    }
+    CHECK(ts_dec_next(&dec, &t_ms, NULL, &out) == ESP_ERR_NOT_FOUND);
+}
+
+// Un bloque lleno rechaza la muestra y queda decodificable
+static void test_overflow_rollback(void) {
+    uint8_t buf[100];
+    ts_enc_t e;
+    ts_enc_init(&e, buf, sizeof(buf), ALL_FIELDS, 0);
+    SensorData d = {0};
+    int added = 0;
+    for (;; ++added) {
+        d.co2 = (uint16_t)(400 + added * 37);
+        d.pm2p5 = (float)added * 3.3f;
+        if (ts_enc_add(&e, (uint32_t)added * 5000, FLAGS_BOTH, &d) != ESP_OK) break;
+    }
+    CHECK(added > 0);
+    size_t len = ts_enc_finish(&e);
+    CHECK(len <= sizeof(buf));
+
+    ts_dec_t dec;
+    ts_dec_init(&dec, buf, len);
+    SensorData out;
+    uint32_t t_ms;
+    int k = 0;
+    while (ts_dec_next(&dec, &t_ms, NULL, &out) == ESP_OK) {
+        CHECK(t_ms == (uint32_t)k * 5000);
+        CHECK(out.co2 == 400 + k * 37);
+        k++;
+    }
+    CHECK(k == added);
+}
+
+// Un sensor que falta en la primera muestra del bloque no tiene dato (no 0)
+// hasta que aparece; el otro sigue con su último valor
+static void test_first_sample_missing_sensor(void) {
+    uint8_t buf[256];
+    ts_enc_t e;
+    ts_enc_init(&e, buf, sizeof(buf), ALL_FIELDS, 0);
+    SensorData d = {0};
+    d.co2 = 800;
+    d.pm2p5 = 12.3f;
+    d.avg_temp = 21.5f;
+    d.scd_temp = 22.0f;
+    CHECK(ts_enc_add(&e, 0, SENSOR_FIELD_SRC_SEN, &d) == ESP_OK);
+    d.co2 = 810;
+    d.pm2p5 = 99.0f;
+    CHECK(ts_enc_add(&e, 5000, SENSOR_FIELD_SRC_SCD, &d) == ESP_OK);
+    CHECK(ts_enc_add(&e, 10000, FLAGS_BOTH, &d) == ESP_OK);
+    size_t len = ts_enc_finish(&e);
+
+    ts_dec_t dec;
+    CHECK(ts_dec_init(&dec, buf, len) == ESP_OK);
+    SensorData out;
+    memset(&out, 0xA5, sizeof(out));
+    CHECK(ts_dec_next(&dec, NULL, NULL, &out) == ESP_OK);
+    CHECK(!ts_dec_has_value(&dec, SENSOR_FIELD_CO2));
+    CHECK(out.co2 == 0);
+    CHECK(ts_dec_has_value(&dec, SENSOR_FIELD_PM2P5));
+    CHECK(same_value(SENSOR_FIELD_PM2P5, 12.3f, out.pm2p5));
+    CHECK(same_value(SENSOR_FIELD_CTE, 21.5f, out.avg_temp));
+
+    CHECK(ts_dec_next(&dec, NULL, NULL, &out) == ESP_OK);
+    CHECK(ts_dec_has_value(&dec, SENSOR_FIELD_CO2));
+    CHECK(out.co2 == 810);
+    CHECK(same_value(SENSOR_FIELD_PM2P5, 12.3f, out.pm2p5));
+
+    CHECK(ts_dec_next(&dec, NULL, NULL, &out) == ESP_OK);
+    CHECK(same_value(SENSOR_FIELD_PM2P5, 99.0f, out.pm2p5));
+
+    // Y al revés: sin SEN en la primera, PM es NaN
+    ts_enc_init(&e, buf, sizeof(buf), ALL_FIELDS, 0);
+    CHECK(ts_enc_add(&e, 0, SENSOR_FIELD_SRC_SCD, &d) == ESP_OK);
+    len = ts_enc_finish(&e);
+    CHECK(ts_dec_init(&dec, buf, len) == ESP_OK);
+    CHECK(ts_dec_next(&dec, NULL, NULL, &out) == ESP_OK);
+    CHECK(isnan(out.pm2p5) && isnan(out.avg_temp));
+    CHECK(!ts_dec_has_value(&dec, SENSOR_FIELD_PM2P5));
+    CHECK(out.co2 == 810);
+}
+
+static void test_bad_header(void) {
+    uint8_t buf[64];
+    ts_enc_t e;
+    ts_dec_t dec;
+    CHECK(ts_enc_init(&e, buf, 8, ALL_FIELDS, 0) == ESP_ERR_INVALID_SIZE);
+    ts_enc_init(&e, buf, sizeof(buf), ALL_FIELDS, 0);
+    size_t len = ts_enc_finish(&e);
+    CHECK(ts_dec_init(&dec, buf, len) == ESP_OK);
+    CHECK(ts_dec_next(&dec, NULL, NULL, NULL) == ESP_ERR_NOT_FOUND);
+    buf[2] = 2;    // versión anterior: los campos arrancaban en 0, no sin dato
+    CHECK(ts_dec_init(&dec, buf, len) == ESP_ERR_INVALID_VERSION);
+    CHECK(ts_dec_init(&dec, buf, 4) == ESP_ERR_INVALID_SIZE);
+}
+
+int main(void) {
+    test_random_series();
+    test_extremes();
+    test_overflow_rollback();
+    test_first_sample_missing_sensor();
+    test_bad_header();
+    return host_test_result("test_ts_codec");
+}
@@ -0,0 +1,118 @@
+// Ida y vuelta window_cbor_encode -> window_cbor_decode
+#include <math.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "window_cbor.h"
+
+static window_record_t sample_window(void) {
+    window_record_t w = {0};
+    w.avg.co2 = 612;
+    w.avg.pm1p0 = 4.37f;
+    w.avg.pm2p5 = 7.91f;
+    w.avg.pm4p0 = 9.05f;
+    w.avg.pm10p0 = 10.2f;
+    w.avg.voc = 101.5f;
+    w.avg.nox = 1.0f;
+    w.avg.avg_temp = 23.47f;
+    w.avg.avg_hum = 48.12f;
+    w.avg.sen_temp = -3.25f;    // negativos van como NINT
+    w.avg.sen_hum = 47.9f;
+    w.start_epoch = 1760000000u;
+    w.end_epoch = 1760000300u;
+    w.scd_samples = 60;
+    w.sen_samples = 59;
+    w.agg[SENSOR_FIELD_PM2P5] = 3;
+    w.agg[SENSOR_FIELD_SEN_HUM] = 1;
+    return w;
+}
+
+static void check_same(const window_record_t *w, const window_record_t *o) {
+    CHECK(o->avg.co2 == w->avg.co2);
+    for (int f = 0; f < SENSOR_FIELD_COUNT; ++f) {
+        // x100 / x10 según el campo: el error máximo es medio paso
+        float step = g_sensor_fields[f].decimals >= 2 ? 0.01f : 0.1f;
+        CHECK(fabsf(sensor_field_get(&o->avg, f) - sensor_field_get(&w->avg, f)) <= step / 2 + 1e-4f);
+        CHECK(o->agg[f] == w->agg[f]);
+    }
+    CHECK(o->avg.scd_temp == o->avg.avg_temp);
+    CHECK(o->start_epoch == w->start_epoch);
+    CHECK(o->end_epoch == w->end_epoch);
+    CHECK(o->scd_samples == w->scd_samples);
+    CHECK(o->sen_samples == w->sen_samples);
+}
+
+static void test_round_trip(void) {
+    window_record_t w = sample_window(), o;
+    window_cbor_meta_t meta;
+    uint8_t buf[WINDOW_CBOR_MAX_LEN];
+
+    size_t n = window_cbor_encode(&w, "ESP32-test", NULL, buf, sizeof(buf));
+    CHECK(n > 0);
+    CHECK(window_cbor_decode(buf, n, &o, &meta) == ESP_OK);
+    check_same(&w, &o);
+    CHECK(strcmp(meta.device_id, "ESP32-test") == 0);
+    CHECK(meta.ver[0] == '\0' && meta.ciudad[0] == '\0' && meta.inicio_epoch == 0);
+}
+
+static void test_round_trip_extra(void) {
+    window_record_t w = sample_window(), o;
+    window_cbor_meta_t meta;
+    window_cbor_extra_t extra = { .ver = "1.0.9", .ciudad = "Monterrey, N.L.", .inicio_epoch = 1759990000u };
+    uint8_t buf[WINDOW_CBOR_MAX_LEN];
+
+    size_t n = window_cbor_encode(&w, "ESP32-test", &extra, buf, sizeof(buf));
+    CHECK(n > 0);
+    CHECK(window_cbor_decode(buf, n, &o, &meta) == ESP_OK);
+    check_same(&w, &o);
+    CHECK(strcmp(meta.ver, "1.0.9") == 0);
+    CHECK(strcmp(meta.ciudad, "Monterrey, N.L.") == 0);
+    CHECK(meta.inicio_epoch == 1759990000u);
+}
+
+static void test_no_agg_no_device(void) {
+    window_record_t w = sample_window(), o;
+    memset(w.agg, 0, sizeof(w.agg));
+    uint8_t buf[WINDOW_CBOR_MAX_LEN];
+
+    size_t n = window_cbor_encode(&w, NULL, NULL, buf, sizeof(buf));
+    CHECK(n > 0);
+    CHECK(window_cbor_decode(buf, n, &o, NULL) == ESP_OK);
+    check_same(&w, &o);
+}
+
+static void test_overflow_and_truncation(void) {
+    window_record_t w = sample_window(), o;
+    uint8_t buf[WINDOW_CBOR_MAX_LEN];
+
+    size_t n = window_cbor_encode(&w, "ESP32-test", NULL, buf, sizeof(buf));
+    CHECK(window_cbor_encode(&w, "ESP32-test", NULL, buf, n - 1) == 0);
+    // Cada prefijo propio es inválido
+    for (size_t len = 0; len < n; ++len) {
+        CHECK(window_cbor_decode(buf, len, &o, NULL) != ESP_OK);
+    }
+}
+
+static void test_unknown_keys_skipped(void) {
+    window_record_t w = sample_window(), o;
+    uint8_t buf[WINDOW_CBOR_MAX_LEN + 16];
+
+    size_t n = window_cbor_encode(&w, NULL, NULL, buf, WINDOW_CBOR_MAX_LEN);
+    // Mapa con cabecera de un byte (menos de 24 pares)
+    CHECK(n > 0 && (buf[0] & 0xE0) == 0xA0 && (buf[0] & 0x1F) < 23);
+    // Agrega al mapa la clave 40 con un texto: un servidor viejo la ignora
+    buf[0]++;
+    const uint8_t extra[] = { 0x18, 40, 0x62, 'h', 'i' };
+    memcpy(buf + n, extra, sizeof(extra));
+    CHECK(window_cbor_decode(buf, n + sizeof(extra), &o, NULL) == ESP_OK);
+    check_same(&w, &o);
+}
+
+int main(void) {
+    test_round_trip();
+    test_round_trip_extra();
+    test_no_agg_no_device();
+    test_overflow_and_truncation();
+    test_unknown_keys_skipped();
+    return host_test_result("test_window_cbor");
+}